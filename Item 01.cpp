@@ -1,9 +1,32 @@
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <compare>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
 #include <iostream>
 #include <iterator>
+#include <mutex>
+#include <optional>
+#include <span>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <utility>
 #include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 /**
  * Item 01 - Iterators
  *
@@ -217,4 +240,1359 @@ int main()
     {
         std::cout << element << ' ';
     }
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * A packed Date.
+ *
+ * The Date above is a std::string, so every std::find() over a std::vector<Date> is a string comparison per element, and
+ * every element may own a heap buffer of its own. A calendar date fits in far less: the number of days since 01/01/1970
+ * fits in 4 bytes, sorts the same way the dates do, and compares with a single integer comparison.
+ *
+ * The text form is still "MM/DD/YY", so operator >> and operator << keep working as before. Two-digit years follow the
+ * POSIX convention: 70-99 are 1970-1999, and 00-69 are 2000-2069. "MM/DD/YYYY", as todaysDate() returns it, is accepted
+ * too, and years outside that window are printed with four digits.
+ *
+ * It's called PackedDate rather than Date, so the two can live side by side in this Item.
+*/
+
+class PackedDate
+{
+    public:
+        constexpr PackedDate() noexcept = default;
+        PackedDate(std::string_view date);
+
+        static constexpr PackedDate fromCivil(int year, unsigned month, unsigned day) noexcept;
+        static constexpr PackedDate fromDays(std::int32_t days) noexcept;
+        static std::optional<PackedDate> parse(std::string_view text) noexcept;
+
+        constexpr std::int32_t days() const noexcept;
+        char* format(char* out) const noexcept;
+        std::string getDate() const;
+
+        friend constexpr bool operator == (PackedDate date, PackedDate another) noexcept = default;
+        friend constexpr auto operator <=> (PackedDate date, PackedDate another) noexcept = default;
+
+        bool operator == (std::string_view another) const;
+
+    friend std::istream& operator >> (std::istream& is, PackedDate& date);
+    friend std::ostream& operator << (std::ostream& os, const PackedDate& date);
+
+    private:
+        constexpr explicit PackedDate(std::int32_t days) noexcept
+            : m_days { days } { }
+
+        std::int32_t m_days { 0 };
+};
+
+static_assert(sizeof(PackedDate) == 4);
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Converting between days and the civil calendar.
+ *
+ * These are Howard Hinnant's days_from_civil() and civil_from_days(). Shifting the year to start in March puts the leap
+ * day at its very end, and then every month length follows from one linear formula, with no tables and no branches
+ * beyond the era split.
+*/
+
+constexpr PackedDate PackedDate::fromCivil(int year, unsigned month, unsigned day) noexcept
+{
+    year -= month <= 2;
+
+    const int era { (year >= 0 ? year : year - 399) / 400 };
+    const unsigned yearOfEra { static_cast<unsigned>(year - era * 400) };
+    const unsigned dayOfYear { (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1 };
+    const unsigned dayOfEra { yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear };
+
+    return PackedDate { era * 146097 + static_cast<std::int32_t>(dayOfEra) - 719468 };
+}
+
+
+constexpr PackedDate PackedDate::fromDays(std::int32_t days) noexcept
+{
+    return PackedDate { days };
+}
+
+
+constexpr std::int32_t PackedDate::days() const noexcept
+{
+    return m_days;
+}
+
+
+char* PackedDate::format(char* out) const noexcept
+{
+    const std::int32_t days { m_days + 719468 };
+    const std::int32_t era { (days >= 0 ? days : days - 146096) / 146097 };
+    const unsigned dayOfEra { static_cast<unsigned>(days - era * 146097) };
+    const unsigned yearOfEra { (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365 };
+    const unsigned dayOfYear { dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100) };
+    const unsigned shifted { (5 * dayOfYear + 2) / 153 };
+    const unsigned day { dayOfYear - (153 * shifted + 2) / 5 + 1 };
+    const unsigned month { shifted < 10 ? shifted + 3 : shifted - 9 };
+    const int year { static_cast<int>(yearOfEra) + era * 400 + (month <= 2) };
+
+    auto twoDigits = [](char* at, unsigned value)
+    {
+        at[0] = static_cast<char>('0' + value / 10);
+        at[1] = static_cast<char>('0' + value % 10);
+    };
+
+    twoDigits(out, month);
+    out[2] = '/';
+    twoDigits(out + 3, day);
+    out[5] = '/';
+
+    if (year >= 1970 && year < 2070)
+    {
+        twoDigits(out + 6, static_cast<unsigned>(year % 100));
+
+        return out + 8;
+    }
+
+    unsigned fullYear { static_cast<unsigned>(std::clamp(year, 0, 9999)) };
+
+    twoDigits(out + 6, fullYear / 100);
+    twoDigits(out + 8, fullYear % 100);
+
+    return out + 10;
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Parsing.
+ *
+ * parse() reads all eight bytes of "MM/DD/YY" as one 64-bit word and checks and converts them together (SWAR, SIMD within
+ * a register):
+ *
+ * - Masking the high nibble of every digit and all of every '/' must give exactly "00/00/00" with '0' = 0x30.
+ * - Adding 6 to the low nibble of every digit must not carry out of it, i.e. no digit is above 9.
+ * - Multiplying by 10 and adding the word shifted by one byte leaves every two-digit field in a single byte.
+ *
+ * The month and day range checks are folded into the result with "&" instead of "&&", so a date that is wrong in some
+ * random way doesn't cost a mispredicted branch. The bytes are assembled in little-endian order explicitly, which
+ * compilers turn into one load on little-endian machines.
+*/
+
+std::optional<PackedDate> PackedDate::parse(std::string_view text) noexcept
+{
+    if (text.size() != 8 && text.size() != 10)
+    {
+        return std::nullopt;
+    }
+
+    std::uint64_t word { 0 };
+
+    for (std::size_t i { 0 }; i < 8; ++i)
+    {
+        word |= std::uint64_t { static_cast<unsigned char>(text[i]) } << (8 * i);
+    }
+
+    constexpr std::uint64_t digitMask { 0x0F0F'000F'0F00'0F0F };
+    constexpr std::uint64_t shapeMask { 0xF0F0'FFF0'F0FF'F0F0 };
+    constexpr std::uint64_t shape { 0x3030'2F30'302F'3030 };
+
+    const std::uint64_t digits { word & digitMask };
+    const std::uint64_t fields { digits * 10 + (digits >> 8) };
+
+    const unsigned month { static_cast<unsigned>(fields & 0xFF) };
+    const unsigned day { static_cast<unsigned>((fields >> 24) & 0xFF) };
+    int year { static_cast<int>((fields >> 48) & 0xFF) };
+
+    const bool shaped { (word & shapeMask) == shape };
+    const bool decimal { ((digits + 0x0606'0006'0600'0606) & 0xF0F0'00F0'F000'F0F0) == 0 };
+
+    bool valid { shaped && decimal };
+
+    if (text.size() == 10)
+    {
+        // "MM/DD/YYYY": the word holds "MM/DD/YY", and the last two characters complete the year
+        const unsigned low { static_cast<unsigned char>(text[8]) - 48u };
+        const unsigned high { static_cast<unsigned char>(text[9]) - 48u };
+
+        valid &= (low <= 9) & (high <= 9);
+        year = year * 100 + static_cast<int>(low * 10 + high);
+    }
+    else
+    {
+        year += year < 70 ? 2000 : 1900;
+    }
+
+    const bool leap { year % 4 == 0 && (year % 100 != 0 || year % 400 == 0) };
+    const unsigned monthDays { 28 + ((0x03BB'EECCu >> (2 * (month & 15))) & 3) + (leap & (month == 2)) };
+
+    valid &= (month - 1 < 12) & (day - 1 < monthDays);
+
+    if (!valid)
+    {
+        return std::nullopt;
+    }
+
+    return fromCivil(year, month, day);
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * The rest of the interface.
+ *
+ * Constructing from text that isn't a date throws, since there is no "no date" value left to hold. Comparing against
+ * text parses it first; a search should construct the PackedDate once and compare PackedDates, e.g.
+ * std::find(e.begin(), e.end(), PackedDate { "01/01/95" }).
+ *
+ * operator >> reads one whitespace-delimited token, which for a date fits in std::string's small buffer, and sets failbit
+ * if it isn't a date.
+*/
+
+PackedDate::PackedDate(std::string_view date)
+{
+    std::optional<PackedDate> parsed { parse(date) };
+
+    if (!parsed)
+    {
+        throw("Invalid date.");
+    }
+
+    m_days = parsed->m_days;
+}
+
+
+std::string PackedDate::getDate() const
+{
+    char text[10];
+
+    return std::string(text, format(text));
+}
+
+
+bool PackedDate::operator == (std::string_view another) const
+{
+    std::optional<PackedDate> parsed { parse(another) };
+
+    return parsed && *parsed == *this;
+}
+
+
+// Intput operator for "PackedDate" class
+std::istream& operator >> (std::istream& is, PackedDate& date)
+{
+    std::string text;
+
+    if (is >> text)
+    {
+        if (std::optional<PackedDate> parsed { PackedDate::parse(text) })
+        {
+            date = *parsed;
+        }
+        else
+        {
+            is.setstate(std::ios_base::failbit);
+        }
+    }
+
+    return is;
+}
+
+
+// Output operator for "PackedDate" class
+std::ostream& operator << (std::ostream& os, const PackedDate& date)
+{
+    char text[10];
+
+    return os.write(text, date.format(text) - text);
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Bulk loading.
+ *
+ * Reading dates through std::istream_iterator parses one token at a time, through a locale-aware stream, on one thread,
+ * into a vector that reallocates about thirty times on the way to 500 million elements. Since dates are fixed-width text,
+ * almost all of that can go:
+ *
+ * - loadDates() maps the whole file, so there is no read() loop and no copy into a stream buffer.
+ * - parseDates() cuts the text into one chunk per hardware thread. A cut is moved forward to the next whitespace, so no
+ *   record is ever split between two chunks.
+ * - Every chunk gets its own thread, which first counts the records in it. Counting only looks for separators, which is
+ *   far cheaper than parsing.
+ * - The counts say exactly how big the result is, and where each chunk's dates go in it. The result is allocated once,
+ *   and every thread then parses its chunk straight into its own stretch of it. There are no per-chunk buffers and
+ *   nothing is copied afterwards, so the dates are in memory only once.
+ *
+ * Like the stream version, parsing stops at the first token that isn't a date; unlike it, that's reported with an
+ * exception rather than by quietly returning fewer dates.
+*/
+
+constexpr bool isSeparator(char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+
+struct DateChunk
+{
+    std::string_view m_text;
+    PackedDate* m_p_dates { nullptr };
+    std::size_t m_count { 0 };
+    bool m_valid { true };
+};
+
+
+void countChunk(DateChunk& chunk)
+{
+    bool separated { true };
+
+    for (char c : chunk.m_text)
+    {
+        chunk.m_count += separated && !isSeparator(c);
+        separated = isSeparator(c);
+    }
+}
+
+
+void parseChunk(DateChunk& chunk)
+{
+    const char* position { chunk.m_text.data() };
+    const char* end { position + chunk.m_text.size() };
+
+    while (true)
+    {
+        while (position != end && isSeparator(*position))
+        {
+            ++position;
+        }
+
+        if (position == end)
+        {
+            return;
+        }
+
+        const char* token { position };
+
+        while (position != end && !isSeparator(*position))
+        {
+            ++position;
+        }
+
+        std::optional<PackedDate> date { PackedDate::parse({ token, static_cast<std::size_t>(position - token) }) };
+
+        if (!date)
+        {
+            chunk.m_valid = false;
+
+            return;
+        }
+
+        *chunk.m_p_dates++ = *date;
+    }
+}
+
+
+// Runs function on every chunk, one thread each, with the first chunk on the calling thread
+void forEachChunk(std::vector<DateChunk>& parts, void (*function)(DateChunk&))
+{
+    std::vector<std::thread> workers;
+    std::size_t started { 1 };
+
+    try
+    {
+        for ( ; started < parts.size(); ++started)
+        {
+            workers.emplace_back(function, std::ref(parts[started]));
+        }
+    }
+    catch ( ... )
+    {
+        // Out of threads; do the rest here
+    }
+
+    function(parts[0]);
+
+    for (std::size_t i { started }; i < parts.size(); ++i)
+    {
+        function(parts[i]);
+    }
+
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+std::vector<PackedDate> parseDates(std::string_view text,
+                                   std::size_t threads = std::max(1u, std::thread::hardware_concurrency()))
+{
+    constexpr std::size_t minimumChunk { std::size_t { 1 } << 20 };
+
+    std::size_t chunks { std::max<std::size_t>(std::min(text.size() / minimumChunk, threads), 1) };
+    std::vector<DateChunk> parts(chunks);
+
+    for (std::size_t i { 0 }, begin { 0 }; i < chunks; ++i)
+    {
+        std::size_t end { i + 1 == chunks ? text.size() : std::max(begin, text.size() / chunks * (i + 1)) };
+
+        while (end < text.size() && !isSeparator(text[end]))
+        {
+            ++end;
+        }
+
+        parts[i].m_text = text.substr(begin, end - begin);
+        begin = end;
+    }
+
+    forEachChunk(parts, countChunk);
+
+    std::size_t total { 0 };
+
+    for (const DateChunk& part : parts)
+    {
+        total += part.m_count;
+    }
+
+    // Allocating here rather than in the workers keeps bad_alloc on this thread
+    std::vector<PackedDate> dates(total);
+    PackedDate* out { dates.data() };
+
+    for (DateChunk& part : parts)
+    {
+        part.m_p_dates = out;
+        out += part.m_count;
+    }
+
+    forEachChunk(parts, parseChunk);
+
+    for (const DateChunk& part : parts)
+    {
+        if (!part.m_valid)
+        {
+            throw("Invalid date in input.");
+        }
+    }
+
+    return dates;
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * The mapping is private and read-only, and we tell the kernel we'll read it front to back so it reads ahead
+ * aggressively. It's unmapped as soon as parsing is done; the dates don't point into it.
+*/
+
+std::vector<PackedDate> loadDates(const std::string& path)
+{
+    int file { open(path.c_str(), O_RDONLY | O_CLOEXEC) };
+
+    if (file < 0)
+    {
+        throw("Cannot open date file.");
+    }
+
+    struct stat status { };
+
+    if (fstat(file, &status) != 0)
+    {
+        close(file);
+        throw("Cannot open date file.");
+    }
+
+    std::size_t size { static_cast<std::size_t>(status.st_size) };
+
+    if (size == 0)
+    {
+        close(file);
+
+        return { };
+    }
+
+    void* mapping { mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0) };
+    close(file);
+
+    if (mapping == MAP_FAILED)
+    {
+        throw("Cannot map date file.");
+    }
+
+    madvise(mapping, size, MADV_SEQUENTIAL);
+
+    try
+    {
+        std::vector<PackedDate> dates { parseDates({ static_cast<const char*>(mapping), size }) };
+        munmap(mapping, size);
+
+        return dates;
+    }
+    catch ( ... )
+    {
+        munmap(mapping, size);
+        throw;
+    }
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * A sorted index.
+ *
+ * Finding first and last with two std::find() scans is linear, and copying [ first, last ) is only meaningful if the
+ * dates happen to be in order. DateIndex keeps them sorted, so any range of dates is one contiguous run, and finds the
+ * ends of that run in O(log n).
+ *
+ * A plain binary search over a big sorted array touches a new cache line at nearly every step, and the first dozen steps
+ * jump around the whole array. DateIndex searches in two stages instead:
+ *
+ * - The array is cut into blocks of one cache line (16 dates). The first date of every block is copied into a separate,
+ *   much smaller tree stored in Eytzinger (BFS) order, where the children of node k are 2k and 2k + 1. The top levels of
+ *   that tree share a few cache lines that stay hot, and the search is a branch-free descent.
+ * - Within the one block that the tree points to, we simply count the dates below the key. Sixteen comparisons in one
+ *   cache line, which the compiler vectorizes.
+ *
+ * Inserting into a sorted array is linear, so new dates go into a small sorted delta buffer instead, which is merged into
+ * the array once it has grown to about the square root of the array's size. Inserting then costs O(sqrt n) amortized, and
+ * a range query returns two spans: one into the array, one into the delta.
+ *
+ * The spans point into the index and are invalidated by the next insert() or merge().
+*/
+
+struct DateRange
+{
+    std::span<const PackedDate> m_indexed;
+    std::span<const PackedDate> m_recent;                   // Inserted since the last merge
+
+    std::size_t size() const
+    {
+        return m_indexed.size() + m_recent.size();
+    }
+};
+
+class DateIndex
+{
+    public:
+        explicit DateIndex(std::vector<PackedDate> dates = { });
+
+        std::size_t size() const;
+        void insert(PackedDate date);
+        void merge();
+
+        DateRange range(PackedDate from, PackedDate to) const;      // [ from, to )
+
+    private:
+        static constexpr std::size_t blockSize { 64 / sizeof(PackedDate) };
+
+        static void build(const std::vector<PackedDate>& sorted, std::vector<PackedDate>& tree,
+                          std::vector<std::uint32_t>& blocks);
+        static void fill(const std::vector<PackedDate>& sorted, std::vector<PackedDate>& tree,
+                         std::vector<std::uint32_t>& blocks, std::size_t& next, std::size_t node);
+
+        std::size_t lowerBound(PackedDate date) const;
+
+        std::vector<PackedDate> m_sorted;
+        std::vector<PackedDate> m_delta;
+        std::vector<PackedDate> m_tree;                         // First date of every block, in Eytzinger order from 1
+        std::vector<std::uint32_t> m_blocks;                    // The block each node of m_tree came from
+};
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Building the tree.
+ *
+ * An in-order walk of the implicit tree visits the nodes in sorted order, so filling the nodes during that walk with the
+ * block fences, in order, gives the Eytzinger layout.
+*/
+
+DateIndex::DateIndex(std::vector<PackedDate> dates)
+    : m_sorted { std::move(dates) }
+{
+    std::sort(m_sorted.begin(), m_sorted.end());
+    build(m_sorted, m_tree, m_blocks);
+}
+
+
+void DateIndex::build(const std::vector<PackedDate>& sorted, std::vector<PackedDate>& tree,
+                      std::vector<std::uint32_t>& blocks)
+{
+    std::size_t fences { (sorted.size() + blockSize - 1) / blockSize };
+    std::size_t next { 0 };
+
+    tree.assign(fences + 1, PackedDate { });
+    blocks.assign(fences + 1, 0);
+
+    fill(sorted, tree, blocks, next, 1);
+}
+
+
+void DateIndex::fill(const std::vector<PackedDate>& sorted, std::vector<PackedDate>& tree,
+                     std::vector<std::uint32_t>& blocks, std::size_t& next, std::size_t node)
+{
+    if (node < tree.size())
+    {
+        fill(sorted, tree, blocks, next, 2 * node);
+
+        tree[node] = sorted[next * blockSize];
+        blocks[node] = static_cast<std::uint32_t>(next++);
+
+        fill(sorted, tree, blocks, next, 2 * node + 1);
+    }
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Searching.
+ *
+ * The descent goes right whenever the node is below the key, and always runs to the bottom of the tree. The path it took
+ * is then spelled out in the bits of k: the last time it went left was at the node we want, so we strip the trailing
+ * right turns (the trailing ones) and that final left turn. If it never went left, k becomes 0 and every fence is below
+ * the key.
+ *
+ * The first date not below the key is then in the block before the first fence that isn't, or is that fence itself.
+*/
+
+std::size_t DateIndex::lowerBound(PackedDate date) const
+{
+    std::size_t fences { m_tree.size() - 1 };
+    std::size_t k { 1 };
+
+    while (k <= fences)
+    {
+        k = 2 * k + (m_tree[k] < date);
+    }
+
+    k >>= std::countr_one(k) + 1;
+
+    std::size_t block { k == 0 ? fences : m_blocks[k] };
+
+    if (block == 0)
+    {
+        return 0;
+    }
+
+    std::size_t begin { (block - 1) * blockSize };
+    std::size_t end { std::min(begin + blockSize, m_sorted.size()) };
+    std::size_t below { 0 };
+
+    for (std::size_t i { begin }; i < end; ++i)
+    {
+        below += m_sorted[i] < date;
+    }
+
+    return begin + below;
+}
+
+
+DateRange DateIndex::range(PackedDate from, PackedDate to) const
+{
+    if (!(from < to))
+    {
+        return { };
+    }
+
+    std::size_t first { lowerBound(from) };
+    std::size_t last { lowerBound(to) };
+
+    auto recentFirst { std::lower_bound(m_delta.begin(), m_delta.end(), from) };
+    auto recentLast { std::lower_bound(recentFirst, m_delta.end(), to) };
+
+    return { std::span<const PackedDate> { m_sorted.data() + first, last - first },
+             std::span<const PackedDate> { recentFirst, recentLast } };
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Updating.
+ *
+ * merge() builds the new array and tree on the side and only then swaps them in, so a bad_alloc leaves the index as it
+ * was. insert() merges a full delta before it adds to it, so it gives the strong guarantee too.
+*/
+
+std::size_t DateIndex::size() const
+{
+    return m_sorted.size() + m_delta.size();
+}
+
+
+void DateIndex::insert(PackedDate date)
+{
+    std::size_t limit { std::max<std::size_t>(64, static_cast<std::size_t>(std::sqrt(double(m_sorted.size())))) };
+
+    if (m_delta.size() >= limit)
+    {
+        merge();
+    }
+
+    m_delta.insert(std::upper_bound(m_delta.begin(), m_delta.end(), date), date);
+}
+
+
+void DateIndex::merge()
+{
+    if (m_delta.empty())
+    {
+        return;
+    }
+
+    std::vector<PackedDate> sorted(m_sorted.size() + m_delta.size());
+    std::vector<PackedDate> tree;
+    std::vector<std::uint32_t> blocks;
+
+    std::merge(m_sorted.begin(), m_sorted.end(), m_delta.begin(), m_delta.end(), sorted.begin());
+    build(sorted, tree, blocks);
+
+    m_sorted.swap(sorted);
+    m_tree.swap(tree);
+    m_blocks.swap(blocks);
+    m_delta.clear();
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Stable handles.
+ *
+ * Any insert into a vector may reallocate it and invalidate every iterator, pointer and index into it, and an erase shifts
+ * everything after it. Recomputing first and last after each update costs a search every time. A slot map separates the
+ * two things an iterator is used for:
+ *
+ * - The values live densely packed in one vector, so iterating over all of them is as fast as over a std::vector. An erase
+ *   moves the last value into the hole, so the order isn't preserved.
+ * - A Handle names a slot, and a slot knows where its value currently is. Handles survive any number of inserts and
+ *   erases, and looking one up, inserting and erasing are all O(1).
+ *
+ * Every slot also has a generation, which is bumped whenever its value is erased. A Handle carries the generation it was
+ * issued with, so a handle to an erased value doesn't silently find whatever value reuses its slot; it finds nothing.
+ *
+ * SlotMap<Date> is the std::vector<Date> from the top of this Item, with Handles where it had first and last.
+*/
+
+struct Handle
+{
+    std::uint32_t m_slot;
+    std::uint32_t m_generation;
+
+    friend bool operator == (Handle handle, Handle another) = default;
+};
+
+template <class T>
+class SlotMap
+{
+    public:
+        std::size_t size() const;
+        bool contains(Handle handle) const;
+
+        Handle insert(const T& value);
+        bool erase(Handle handle);
+
+        T* find(Handle handle);
+        const T* find(Handle handle) const;
+
+        T* begin();
+        T* end();
+        const T* begin() const;
+        const T* end() const;
+
+    private:
+        static constexpr std::uint32_t noSlot { UINT32_MAX };
+
+        struct Slot
+        {
+            std::uint32_t m_index;                              // Into m_values, or the next free slot
+            std::uint32_t m_generation;
+        };
+
+        std::vector<T> m_values;
+        std::vector<std::uint32_t> m_owners;                    // The slot of each value
+        std::vector<Slot> m_slots;
+        std::uint32_t m_free { noSlot };
+};
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Lookup.
+ *
+ * A handle is valid if its slot exists and still has the handle's generation. A free slot's m_index is a free-list link,
+ * but its generation has moved on, so it's never followed as a value index.
+*/
+
+template <class T>
+std::size_t SlotMap<T>::size() const
+{
+    return m_values.size();
+}
+
+
+template <class T>
+bool SlotMap<T>::contains(Handle handle) const
+{
+    return handle.m_slot < m_slots.size() && m_slots[handle.m_slot].m_generation == handle.m_generation;
+}
+
+
+template <class T>
+T* SlotMap<T>::find(Handle handle)
+{
+    return const_cast<T*>(std::as_const(*this).find(handle));
+}
+
+
+template <class T>
+const T* SlotMap<T>::find(Handle handle) const
+{
+    return contains(handle) ? &m_values[ m_slots[handle.m_slot].m_index ] : nullptr;
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Updates.
+ *
+ * insert() reserves room in every vector it's going to grow before it changes any of them, so if anything throws,
+ * nothing has changed. erase() only moves one value and updates two indices; it throws only if T's move assignment does.
+*/
+
+template <class T>
+Handle SlotMap<T>::insert(const T& value)
+{
+    if (m_values.size() == noSlot)
+    {
+        throw("SlotMap is full.");
+    }
+
+    // Doubling, as push_back() would; reserving one more at a time would reallocate on every insert
+    if (m_owners.size() == m_owners.capacity())
+    {
+        m_owners.reserve(2 * m_owners.size() + 1);
+    }
+
+    if (m_free == noSlot && m_slots.size() == m_slots.capacity())
+    {
+        m_slots.reserve(2 * m_slots.size() + 1);
+    }
+
+    m_values.push_back(value);
+
+    std::uint32_t slot { m_free };
+
+    if (slot == noSlot)
+    {
+        slot = static_cast<std::uint32_t>(m_slots.size());
+        m_slots.push_back({ 0, 0 });
+    }
+    else
+    {
+        m_free = m_slots[slot].m_index;
+    }
+
+    m_slots[slot].m_index = static_cast<std::uint32_t>(m_values.size() - 1);
+    m_owners.push_back(slot);
+
+    return { slot, m_slots[slot].m_generation };
+}
+
+
+template <class T>
+bool SlotMap<T>::erase(Handle handle)
+{
+    if (!contains(handle))
+    {
+        return false;
+    }
+
+    Slot& slot { m_slots[handle.m_slot] };
+    std::uint32_t last { static_cast<std::uint32_t>(m_values.size() - 1) };
+
+    if (slot.m_index != last)
+    {
+        m_values[slot.m_index] = std::move(m_values[last]);
+        m_owners[slot.m_index] = m_owners[last];
+        m_slots[ m_owners[last] ].m_index = slot.m_index;
+    }
+
+    m_values.pop_back();
+    m_owners.pop_back();
+
+    ++slot.m_generation;
+    slot.m_index = m_free;
+    m_free = handle.m_slot;
+
+    return true;
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Iteration is over the dense values, in no particular order. Like any pointers into a vector, these are invalidated by
+ * insert() and erase(); hold on to Handles instead.
+*/
+
+template <class T>
+T* SlotMap<T>::begin()
+{
+    return m_values.data();
+}
+
+
+template <class T>
+T* SlotMap<T>::end()
+{
+    return m_values.data() + m_values.size();
+}
+
+
+template <class T>
+const T* SlotMap<T>::begin() const
+{
+    return m_values.data();
+}
+
+
+template <class T>
+const T* SlotMap<T>::end() const
+{
+    return m_values.data() + m_values.size();
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Today's date, cached.
+ *
+ * todaysDate() above is a placeholder. A real one reads the system clock, converts it to the local calendar and formats
+ * it, on every call, although the answer only changes once a day. DateClock does that work once per day instead, on a
+ * background thread, and publishes the result in two atomics:
+ *
+ * - today() is one relaxed load of the PackedDate.
+ * - text() is one relaxed load of the preformatted "MM/DD/YY", which is exactly eight bytes, i.e. one 64-bit word.
+ *
+ * Relaxed is enough, because each value is self-contained: there is nothing else the reader needs to see in the same
+ * state. A caller who needs both to agree across midnight should take today() and format it.
+ *
+ * The thread wakes up at the next local midnight, and at least once a minute besides, so a change to the system clock or
+ * to daylight saving time is picked up within a minute.
+ *
+ * todaysPackedDate() is the real version of todaysDate(), answered from DateClock.
+*/
+
+class DateClock
+{
+    public:
+        static DateClock& instance();
+
+        PackedDate today() const noexcept;
+        std::array<char, 8> text() const noexcept;
+
+        ~DateClock();
+
+        // No copying allowed
+        DateClock(const DateClock& other) = delete;
+        DateClock& operator = (const DateClock& other) = delete;
+
+    private:
+        DateClock();
+
+        std::chrono::system_clock::time_point refresh();
+
+        std::atomic<std::int32_t> m_days;
+        std::atomic<std::uint64_t> m_text;
+
+        std::mutex m_mutex;
+        std::condition_variable m_stop;
+        bool m_stopping { false };
+        std::thread m_thread;
+};
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * The clock publishes the date once before the thread even starts, so today() is right from the first call.
+*/
+
+DateClock& DateClock::instance()
+{
+    static DateClock clock;
+
+    return clock;
+}
+
+
+DateClock::DateClock()
+    : m_days { 0 }, m_text { 0 }
+{
+    std::chrono::system_clock::time_point wake { refresh() };
+
+    m_thread = std::thread { [this, wake]() mutable
+    {
+        std::unique_lock<std::mutex> lock { m_mutex };
+
+        while (!m_stop.wait_until(lock, wake, [this] { return m_stopping; }))
+        {
+            wake = refresh();
+        }
+    } };
+}
+
+
+DateClock::~DateClock()
+{
+    {
+        std::lock_guard<std::mutex> lock { m_mutex };
+        m_stopping = true;
+    }
+
+    m_stop.notify_all();
+    m_thread.join();
+}
+
+
+// Publishes the current local date and returns when to do it again
+std::chrono::system_clock::time_point DateClock::refresh()
+{
+    using namespace std::chrono;
+
+    system_clock::time_point now { system_clock::now() };
+    std::time_t time { system_clock::to_time_t(now) };
+    std::tm local { };
+
+    localtime_r(&time, &local);
+
+    PackedDate date { PackedDate::fromCivil(local.tm_year + 1900, local.tm_mon + 1, local.tm_mday) };
+    char text[10];
+    std::uint64_t word { 0 };
+
+    date.format(text);
+    std::memcpy(&word, text, sizeof(word));
+
+    m_days.store(date.days(), std::memory_order_relaxed);
+    m_text.store(word, std::memory_order_relaxed);
+
+    seconds untilMidnight { 86400 - (local.tm_hour * 3600 + local.tm_min * 60 + local.tm_sec) };
+
+    return now + std::min<seconds>(untilMidnight, minutes { 1 });
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+PackedDate DateClock::today() const noexcept
+{
+    return PackedDate::fromDays(m_days.load(std::memory_order_relaxed));
+}
+
+
+std::array<char, 8> DateClock::text() const noexcept
+{
+    std::uint64_t word { m_text.load(std::memory_order_relaxed) };
+    std::array<char, 8> text;
+
+    std::memcpy(text.data(), &word, sizeof(word));
+
+    return text;
+}
+
+
+PackedDate todaysPackedDate()
+{
+    return DateClock::instance().today();
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * A columnar store.
+ *
+ * Filtering a std::vector<PackedDate> one element at a time, with a branch per element, runs at a fraction of what the
+ * memory bus could deliver. DateColumn stores just the packed days, back to back, and answers predicates with selection
+ * bitmaps, one bit per row, which are cheap to combine, count and iterate:
+ *
+ * - Every predicate comes down to one kernel, "is the day in [ from, from + span ]". Subtracting from first turns that
+ *   into one unsigned comparison, so the kernel has no branches, and with AVX2 it handles eight rows per instruction.
+ *   equals() is a range of one day, and in() merges its set into runs of consecutive days and ORs the runs together.
+ * - The rows are grouped in blocks of 1024, and every block keeps the smallest and largest day it contains. A block whose
+ *   range can't overlap the predicate is skipped without reading it, and a block that lies entirely inside the predicate
+ *   is selected wholesale. On data that arrives roughly in date order, most blocks are one or the other.
+*/
+
+struct Selection
+{
+    std::vector<std::uint64_t> m_words;
+    std::size_t m_rows { 0 };
+
+    bool test(std::size_t row) const
+    {
+        return (m_words[row / 64] >> (row % 64)) & 1;
+    }
+
+    std::size_t count() const
+    {
+        std::size_t selected { 0 };
+
+        for (std::uint64_t word : m_words)
+        {
+            selected += std::popcount(word);
+        }
+
+        return selected;
+    }
+};
+
+class DateColumn
+{
+    public:
+        static constexpr std::size_t blockRows { 1024 };
+
+        DateColumn() = default;
+        explicit DateColumn(std::span<const PackedDate> dates);
+
+        std::size_t size() const;
+        PackedDate operator [] (std::size_t row) const;
+        void append(PackedDate date);
+
+        Selection between(PackedDate from, PackedDate to) const;    // [ from, to ]
+        Selection equals(PackedDate date) const;
+        Selection in(std::span<const PackedDate> set) const;
+
+    private:
+        struct Zone
+        {
+            std::int32_t m_min;
+            std::int32_t m_max;
+        };
+
+        struct Run
+        {
+            std::int32_t m_first;
+            std::int32_t m_last;
+        };
+
+        static std::uint64_t rangeWord(const std::int32_t* days, std::int32_t from, std::uint32_t span);
+
+        Selection select(std::span<const Run> runs) const;
+
+        std::vector<std::int32_t> m_days;
+        std::vector<Zone> m_zones;
+};
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Storage.
+ *
+ * append() keeps the zone of the last block up to date as it goes, so the zone maps never need to be rebuilt.
+*/
+
+DateColumn::DateColumn(std::span<const PackedDate> dates)
+{
+    m_days.reserve(dates.size());
+    m_zones.reserve((dates.size() + blockRows - 1) / blockRows);
+
+    for (PackedDate date : dates)
+    {
+        append(date);
+    }
+}
+
+
+std::size_t DateColumn::size() const
+{
+    return m_days.size();
+}
+
+
+PackedDate DateColumn::operator [] (std::size_t row) const
+{
+    return PackedDate::fromDays(m_days[row]);
+}
+
+
+void DateColumn::append(PackedDate date)
+{
+    std::int32_t day { date.days() };
+
+    if (m_days.size() % blockRows == 0)
+    {
+        m_zones.push_back({ day, day });
+    }
+    else
+    {
+        Zone& zone { m_zones.back() };
+
+        zone.m_min = std::min(zone.m_min, day);
+        zone.m_max = std::max(zone.m_max, day);
+    }
+
+    try
+    {
+        m_days.push_back(day);
+    }
+    catch ( ... )
+    {
+        // Keep the zones in step with the rows; a widened zone is harmless, a zone without rows isn't
+        if (m_days.size() % blockRows == 0)
+        {
+            m_zones.pop_back();
+        }
+
+        throw;
+    }
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * The kernel.
+ *
+ * Computes the selection bits of 64 consecutive rows. AVX2 has no unsigned 32-bit comparison, so both sides get their
+ * sign bit flipped, which maps unsigned order onto signed order. Without AVX2, the plain loop is left to the compiler.
+*/
+
+std::uint64_t DateColumn::rangeWord(const std::int32_t* days, std::int32_t from, std::uint32_t span)
+{
+    std::uint64_t word { 0 };
+
+#if defined(__AVX2__)
+    const __m256i base { _mm256_set1_epi32(from) };
+    const __m256i sign { _mm256_set1_epi32(INT32_MIN) };
+    const __m256i limit { _mm256_xor_si256(_mm256_set1_epi32(static_cast<std::int32_t>(span)), sign) };
+
+    for (int i { 0 }; i < 64; i += 8)
+    {
+        __m256i offset { _mm256_sub_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(days + i)), base) };
+        __m256i outside { _mm256_cmpgt_epi32(_mm256_xor_si256(offset, sign), limit) };
+
+        word |= std::uint64_t { ~static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(outside))) & 0xFF } << i;
+    }
+#else
+    for (int i { 0 }; i < 64; ++i)
+    {
+        std::uint32_t offset { static_cast<std::uint32_t>(days[i]) - static_cast<std::uint32_t>(from) };
+
+        word |= std::uint64_t { offset <= span } << i;
+    }
+#endif
+
+    return word;
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Scanning.
+ *
+ * runs are sorted and disjoint. For every block, only the runs overlapping its zone are evaluated, and a run covering the
+ * whole zone decides the block on its own. The last, partial word of the column is evaluated on a padded copy, and its
+ * padding bits are cleared, so no predicate ever selects a row that doesn't exist.
+*/
+
+Selection DateColumn::select(std::span<const Run> runs) const
+{
+    Selection selection { std::vector<std::uint64_t>((m_days.size() + 63) / 64), m_days.size() };
+
+    for (std::size_t block { 0 }; block < m_zones.size(); ++block)
+    {
+        const Zone& zone { m_zones[block] };
+
+        std::size_t begin { block * blockRows };
+        std::size_t end { std::min(begin + blockRows, m_days.size()) };
+
+        auto below { [&](const Run& run) { return run.m_last < zone.m_min; } };
+        auto within { [&](const Run& run) { return run.m_first <= zone.m_max; } };
+
+        auto first { std::partition_point(runs.begin(), runs.end(), below) };
+        auto last { std::partition_point(first, runs.end(), within) };
+
+        if (first == last)
+        {
+            continue;
+        }
+
+        if (first->m_first <= zone.m_min && first->m_last >= zone.m_max)
+        {
+            for (std::size_t row { begin }; row < end; row += 64)
+            {
+                selection.m_words[row / 64] = ~std::uint64_t { 0 };
+            }
+
+            continue;
+        }
+
+        for (std::size_t row { begin }; row < end; row += 64)
+        {
+            std::int32_t padded[64];
+            const std::int32_t* days { m_days.data() + row };
+
+            if (end - row < 64)
+            {
+                std::fill(std::copy(days, m_days.data() + end, padded), padded + 64, days[0]);
+                days = padded;
+            }
+
+            std::uint64_t word { 0 };
+
+            for (auto run { first }; run != last; ++run)
+            {
+                word |= rangeWord(days, run->m_first, static_cast<std::uint32_t>(run->m_last - run->m_first));
+            }
+
+            selection.m_words[row / 64] = word;
+        }
+    }
+
+    if (std::size_t tail { m_days.size() % 64 })
+    {
+        selection.m_words.back() &= (std::uint64_t { 1 } << tail) - 1;
+    }
+
+    return selection;
+}
+
+
+Selection DateColumn::between(PackedDate from, PackedDate to) const
+{
+    if (to < from)
+    {
+        return { std::vector<std::uint64_t>((m_days.size() + 63) / 64), m_days.size() };
+    }
+
+    Run run { from.days(), to.days() };
+
+    return select({ &run, 1 });
+}
+
+
+Selection DateColumn::equals(PackedDate date) const
+{
+    return between(date, date);
+}
+
+
+Selection DateColumn::in(std::span<const PackedDate> set) const
+{
+    std::vector<std::int32_t> days(set.size());
+    std::vector<Run> runs;
+
+    std::transform(set.begin(), set.end(), days.begin(), [](PackedDate date) { return date.days(); });
+    std::sort(days.begin(), days.end());
+
+    for (std::int32_t day : days)
+    {
+        if (!runs.empty() && day <= runs.back().m_last + 1)
+        {
+            runs.back().m_last = std::max(runs.back().m_last, day);
+        }
+        else
+        {
+            runs.push_back({ day, day });
+        }
+    }
+
+    return select(runs);
 }
\ No newline at end of file
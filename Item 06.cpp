@@ -1,7 +1,27 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <functional>
 #include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
 /**
  * Item 06 - Temporary Object
 */
@@ -15,6 +35,7 @@
 class Employee
 {
     public:
+        std::string m_name;
         std::string m_address;
 };
 
@@ -89,4 +110,916 @@ std::string FindAddress(const std::vector<Employee> employees, std::string_view
     }
 
     return "";
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * A hash index.
+ *
+ * Even written without temporaries, FindAddress() is a linear scan: on a directory of two million employees, every lookup
+ * compares up to two million names. EmployeeDirectory indexes the employees by name in an open-addressing hash table:
+ *
+ * - A slot holds the index of an employee and the upper half of its name's hash. A probe compares names only when the
+ *   halves agree, and it never leaves the table's one array. Probing is linear, and the table is kept at most half full.
+ * - Lookups hash the std::string_view they are given with std::hash<std::string_view>, so no std::string is ever built
+ *   just to look something up.
+ * - When the table fills up, a table twice the size is allocated, but the old one isn't rehashed all at once. Every add()
+ *   moves a few of its slots over, and lookups probe both tables until it's empty, so no single add() pays for rehashing
+ *   the whole directory.
+ *
+ * Names are expected to be unique. An employee added under a name that is already taken is stored, but the index keeps
+ * pointing at the first one, which is the one a linear scan would have found.
+ *
+ * Returning the address as a std::string copies it on every hit and constructs "" on every miss. FindAddress() returns a
+ * std::string_view into the directory instead, or std::nullopt, and allocates nothing. A view is only as good as the
+ * storage behind it, so the directory never moves an employee while anyone might be looking:
+ *
+ * - The employees live in a std::deque, which doesn't move its elements when it grows, so add() invalidates nothing.
+ * - setAddress() doesn't overwrite the old address; it appends an updated copy of the employee and points the index at
+ *   it. Views of the old address stay valid, they just describe the directory as it was.
+ * - Superseded employees are reclaimed by compacting the deque, which does move employees, and which only happens while
+ *   no Epoch is open.
+ *
+ * An Epoch is a scope during which views are safe: FindAddress() takes one, and everything it returns stays valid until
+ * that Epoch ends, whatever add()s and setAddress()es happen meanwhile. The same goes for the pointers find() returns. An
+ * Epoch must not outlive its directory.
+ *
+ * Compaction runs at the end of add() and setAddress(), once superseded employees make up half the deque and no Epoch is
+ * open. A caller who keeps Epochs open across every update can call reclaim() between them.
+*/
+
+class EmployeeDirectory
+{
+    public:
+        class Epoch
+        {
+            public:
+                explicit Epoch(const EmployeeDirectory& directory);
+                ~Epoch();
+
+                // No copying allowed
+                Epoch(const Epoch& other) = delete;
+                Epoch& operator = (const Epoch& other) = delete;
+
+            private:
+                friend class EmployeeDirectory;
+
+                const EmployeeDirectory& m_directory;
+        };
+
+        explicit EmployeeDirectory(std::vector<Employee> employees = { });
+
+        std::size_t size() const;
+        void add(Employee employee);
+        bool setAddress(std::string_view name, std::string address);
+        void reclaim();
+
+        const Employee* find(std::string_view name) const;
+        std::optional<std::string_view> FindAddress(std::string_view name, const Epoch& epoch) const;
+
+    private:
+        struct Slot
+        {
+            std::uint32_t m_employee;                           // Index + 1, 0 if the slot is empty
+            std::uint32_t m_tag;                                // Upper half of the name's hash
+        };
+
+        static constexpr std::size_t minimumSlots { 16 };
+        static constexpr std::size_t migrationStep { 4 };       // Old slots moved per add()
+
+        static std::size_t hash(std::string_view name);
+        static void place(std::vector<Slot>& table, std::uint32_t employee, std::size_t hash);
+
+        Slot* probe(const std::vector<Slot>& table, std::string_view name, std::size_t hash) const;
+        void migrate(std::size_t slots);
+
+        std::deque<Employee> m_employees;
+        std::vector<std::uint32_t> m_superseded;                // Indices of employees no longer indexed
+        std::vector<Slot> m_table;
+        std::vector<Slot> m_old;                                // Still being moved into m_table
+        std::size_t m_migrated { 0 };                           // Slots of m_old already moved
+        std::size_t m_indexed { 0 };                            // Distinct names
+        mutable std::size_t m_epochs { 0 };                     // Open Epochs
+};
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Probing.
+ *
+ * Slots of m_old that have already been moved are left in place, so the probe sequences through it stay intact. An entry
+ * may then be found in both tables, but both point at the same employee.
+*/
+
+std::size_t EmployeeDirectory::hash(std::string_view name)
+{
+    return std::hash<std::string_view> { }(name);
+}
+
+
+EmployeeDirectory::Slot* EmployeeDirectory::probe(const std::vector<Slot>& table, std::string_view name,
+                                                  std::size_t hash) const
+{
+    if (table.empty())
+    {
+        return nullptr;
+    }
+
+    std::size_t mask { table.size() - 1 };
+    std::uint32_t tag { static_cast<std::uint32_t>(hash >> 32) };
+
+    for (std::size_t i { hash & mask }; table[i].m_employee != 0; i = (i + 1) & mask)
+    {
+        if (table[i].m_tag == tag && m_employees[ table[i].m_employee - 1 ].m_name == name)
+        {
+            return const_cast<Slot*>(&table[i]);
+        }
+    }
+
+    return nullptr;
+}
+
+
+void EmployeeDirectory::place(std::vector<Slot>& table, std::uint32_t employee, std::size_t hash)
+{
+    std::size_t mask { table.size() - 1 };
+    std::size_t i { hash & mask };
+
+    while (table[i].m_employee != 0)
+    {
+        i = (i + 1) & mask;
+    }
+
+    table[i] = { employee, static_cast<std::uint32_t>(hash >> 32) };
+}
+
+
+const Employee* EmployeeDirectory::find(std::string_view name) const
+{
+    std::size_t code { hash(name) };
+    const Slot* slot { probe(m_table, name, code) };
+
+    if (!slot)
+    {
+        slot = probe(m_old, name, code);
+    }
+
+    return slot ? &m_employees[slot->m_employee - 1] : nullptr;
+}
+
+
+std::optional<std::string_view> EmployeeDirectory::FindAddress(std::string_view name, const Epoch& epoch) const
+{
+    assert(&epoch.m_directory == this);
+
+    if (const Employee* employee { find(name) })
+    {
+        return employee->m_address;
+    }
+
+    return std::nullopt;
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Growing.
+ *
+ * The table doubles when it would become more than half full, at which point the old table holds half as many names as it
+ * has slots. Filling the new table takes another half as many add()s, and moving four slots per add() empties the old one
+ * long before that, so there is never more than one old table.
+ *
+ * add() and setAddress() allocate everything they need before they change anything visible, so they give the strong
+ * guarantee.
+*/
+
+EmployeeDirectory::EmployeeDirectory(std::vector<Employee> employees)
+    : m_table(std::bit_ceil(std::max(minimumSlots, 2 * employees.size())), Slot { 0, 0 })
+{
+    for (Employee& employee : employees)
+    {
+        add(std::move(employee));
+    }
+}
+
+
+std::size_t EmployeeDirectory::size() const
+{
+    return m_employees.size() - m_superseded.size();
+}
+
+
+void EmployeeDirectory::add(Employee employee)
+{
+    if (m_employees.size() == UINT32_MAX)
+    {
+        throw("EmployeeDirectory is full.");
+    }
+
+    std::size_t code { hash(employee.m_name) };
+    bool indexed { find(employee.m_name) == nullptr };
+
+    if (indexed && 2 * (m_indexed + 1) > m_table.size())
+    {
+        std::vector<Slot> table(std::max(minimumSlots, 2 * m_table.size()), Slot { 0, 0 });
+
+        migrate(m_old.size());
+
+        m_old.swap(m_table);
+        m_table.swap(table);
+        m_migrated = 0;
+    }
+
+    m_employees.push_back(std::move(employee));
+
+    if (indexed)
+    {
+        place(m_table, static_cast<std::uint32_t>(m_employees.size()), code);
+        ++m_indexed;
+    }
+
+    migrate(migrationStep);
+    reclaim();
+}
+
+
+bool EmployeeDirectory::setAddress(std::string_view name, std::string address)
+{
+    std::size_t code { hash(name) };
+    Slot* slot { probe(m_table, name, code) };
+    Slot* old { probe(m_old, name, code) };
+    Slot* current { slot ? slot : old };
+
+    if (!current)
+    {
+        return false;
+    }
+
+    if (m_employees.size() == UINT32_MAX)
+    {
+        throw("EmployeeDirectory is full.");
+    }
+
+    std::uint32_t superseded { current->m_employee - 1 };
+
+    if (m_superseded.size() == m_superseded.capacity())
+    {
+        m_superseded.reserve(2 * m_superseded.size() + 1);
+    }
+
+    m_employees.push_back(Employee { m_employees[superseded].m_name, std::move(address) });
+    m_superseded.push_back(superseded);
+
+    for (Slot* update : { slot, old })
+    {
+        if (update)
+        {
+            update->m_employee = static_cast<std::uint32_t>(m_employees.size());
+        }
+    }
+
+    reclaim();
+
+    return true;
+}
+
+
+void EmployeeDirectory::migrate(std::size_t slots)
+{
+    if (m_old.empty())
+    {
+        return;
+    }
+
+    for (std::size_t end { std::min(m_migrated + slots, m_old.size()) }; m_migrated < end; ++m_migrated)
+    {
+        if (std::uint32_t employee { m_old[m_migrated].m_employee })
+        {
+            place(m_table, employee, hash(m_employees[employee - 1].m_name));
+        }
+    }
+
+    if (m_migrated == m_old.size())
+    {
+        std::vector<Slot> { }.swap(m_old);
+        m_migrated = 0;
+    }
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Epochs and reclamation.
+ *
+ * Compaction slides the live employees down over the superseded ones, keeping their order, and renumbers the slots. The
+ * only allocation is the renumbering table, made before anything moves, so a bad_alloc just postpones the compaction.
+*/
+
+EmployeeDirectory::Epoch::Epoch(const EmployeeDirectory& directory)
+    : m_directory { directory }
+{
+    ++m_directory.m_epochs;
+}
+
+
+EmployeeDirectory::Epoch::~Epoch()
+{
+    --m_directory.m_epochs;
+}
+
+
+void EmployeeDirectory::reclaim()
+{
+    if (m_epochs != 0 || 2 * m_superseded.size() < m_employees.size() || m_superseded.empty())
+    {
+        return;
+    }
+
+    std::vector<std::uint32_t> renumbered;
+
+    try
+    {
+        renumbered.resize(m_employees.size());
+    }
+    catch ( ... )
+    {
+        return;
+    }
+
+    migrate(m_old.size());
+    std::sort(m_superseded.begin(), m_superseded.end());
+
+    auto superseded { m_superseded.cbegin() };
+    std::uint32_t kept { 0 };
+
+    for (std::uint32_t i { 0 }; i < m_employees.size(); ++i)
+    {
+        if (superseded != m_superseded.cend() && *superseded == i)
+        {
+            ++superseded;
+            continue;
+        }
+
+        if (kept != i)
+        {
+            m_employees[kept] = std::move(m_employees[i]);
+        }
+
+        renumbered[i] = ++kept;
+    }
+
+    m_employees.erase(m_employees.begin() + kept, m_employees.end());
+    m_superseded.clear();
+
+    for (Slot& slot : m_table)
+    {
+        if (slot.m_employee != 0)
+        {
+            slot.m_employee = renumbered[slot.m_employee - 1];
+        }
+    }
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Read-copy-update.
+ *
+ * Wrapping a directory in a reader-writer lock makes every lookup write to the lock's shared counter, so with dozens of
+ * reader threads the cache line holding it bounces between cores, and every reader waits whenever the updater holds it.
+ * SharedDirectory gives readers nothing to wait for:
+ *
+ * - The current directory is an immutable snapshot, published through an atomic pointer.
+ * - update() copies the snapshot, applies the changes to the copy, and publishes the copy with a single exchange. Readers
+ *   see either the old snapshot or the new one, never anything in between. Updates are serialized by a mutex that
+ *   readers never touch.
+ * - A replaced snapshot can't be freed while a reader might still be using it, so it's retired along with the epoch in
+ *   which it was replaced. Each reader owns one slot, on a cache line of its own, where it announces the epoch it read
+ *   in, for as long as it is reading. A retired snapshot is freed once every announced epoch is later than its own.
+ *
+ * A read is two atomic loads and two atomic stores around the lookup, none of which ever waits, so readers are wait-free.
+ * A reader that stalls inside read() only delays reclamation, never an update.
+ *
+ * Each update copies the whole directory, so this suits a directory read far more often than it changes. update() takes
+ * a function, so a batch of changes costs one copy.
+ *
+ * Readers use the snapshot's find(), which reads nothing mutable; EmployeeDirectory's Epochs count their owners in a
+ * plain integer and aren't for concurrent use. Views obtained inside read() are valid until it returns.
+*/
+
+class SharedDirectory
+{
+    private:
+        struct alignas(64) Announcement
+        {
+            std::atomic<std::uint64_t> m_epoch { 0 };           // 0 while not reading
+            std::atomic<bool> m_claimed { false };
+        };
+
+    public:
+        static constexpr std::size_t maximumReaders { 128 };
+
+        class Reader
+        {
+            public:
+                explicit Reader(const SharedDirectory& directory);
+                ~Reader();
+
+                // No copying allowed
+                Reader(const Reader& other) = delete;
+                Reader& operator = (const Reader& other) = delete;
+
+                template <class Function>
+                decltype(auto) read(Function function) const;
+
+                std::optional<std::string> FindAddress(std::string_view name) const;
+
+            private:
+                const SharedDirectory& m_directory;
+                Announcement& m_announcement;
+        };
+
+        explicit SharedDirectory(std::vector<Employee> employees = { });
+        ~SharedDirectory();
+
+        // No copying allowed
+        SharedDirectory(const SharedDirectory& other) = delete;
+        SharedDirectory& operator = (const SharedDirectory& other) = delete;
+
+        template <class Function>
+        void update(Function function);
+
+    private:
+        struct Retired
+        {
+            std::uint64_t m_epoch;
+            std::unique_ptr<const EmployeeDirectory> m_directory;
+        };
+
+        Announcement& claim() const;
+        void reclaim();
+
+        std::atomic<const EmployeeDirectory*> m_current;
+        std::atomic<std::uint64_t> m_epoch { 1 };
+        mutable std::array<Announcement, maximumReaders> m_announcements;
+
+        std::mutex m_updating;
+        std::vector<Retired> m_retired;                         // Guarded by m_updating
+};
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Reading.
+ *
+ * The announcement is stored before the pointer is loaded, and both are sequentially consistent. So if a reader loaded a
+ * snapshot before the updater replaced it, the updater is guaranteed to see that reader's announcement, which is no later
+ * than the epoch the snapshot is retired in. A reader that announces a later epoch read the epoch after the replacement,
+ * and loads the new snapshot.
+ *
+ * A Reader is meant to be made once per thread and kept; claiming a slot is the one part of reading that scans. read()
+ * must not be nested on the same Reader.
+*/
+
+SharedDirectory::Reader::Reader(const SharedDirectory& directory)
+    : m_directory { directory }, m_announcement { directory.claim() } { }
+
+
+SharedDirectory::Reader::~Reader()
+{
+    m_announcement.m_claimed.store(false, std::memory_order_release);
+}
+
+
+SharedDirectory::Announcement& SharedDirectory::claim() const
+{
+    for (Announcement& announcement : m_announcements)
+    {
+        if (!announcement.m_claimed.exchange(true, std::memory_order_acquire))
+        {
+            return announcement;
+        }
+    }
+
+    throw("Too many readers.");
+}
+
+
+template <class Function>
+decltype(auto) SharedDirectory::Reader::read(Function function) const
+{
+    struct Leave
+    {
+        Announcement& m_announcement;
+
+        ~Leave()
+        {
+            m_announcement.m_epoch.store(0, std::memory_order_release);
+        }
+    };
+
+    m_announcement.m_epoch.store(m_directory.m_epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+
+    Leave leave { m_announcement };
+
+    return function(*m_directory.m_current.load(std::memory_order_seq_cst));
+}
+
+
+std::optional<std::string> SharedDirectory::Reader::FindAddress(std::string_view name) const
+{
+    return read([name](const EmployeeDirectory& directory) -> std::optional<std::string>
+    {
+        if (const Employee* employee { directory.find(name) })
+        {
+            return employee->m_address;
+        }
+
+        return std::nullopt;
+    });
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Updating.
+ *
+ * If function throws, the copy is discarded and nothing has been published. The slot for retiring the old snapshot is
+ * reserved before the exchange, so nothing can fail after it.
+*/
+
+SharedDirectory::SharedDirectory(std::vector<Employee> employees)
+    : m_current { new EmployeeDirectory { std::move(employees) } } { }
+
+
+SharedDirectory::~SharedDirectory()
+{
+    delete m_current.load(std::memory_order_relaxed);
+}
+
+
+template <class Function>
+void SharedDirectory::update(Function function)
+{
+    std::lock_guard<std::mutex> lock { m_updating };
+
+    auto next { std::make_unique<EmployeeDirectory>(*m_current.load(std::memory_order_relaxed)) };
+
+    function(*next);
+
+    if (m_retired.size() == m_retired.capacity())
+    {
+        m_retired.reserve(2 * m_retired.size() + 1);
+    }
+
+    std::unique_ptr<const EmployeeDirectory> previous { m_current.exchange(next.release(), std::memory_order_seq_cst) };
+
+    m_retired.push_back({ m_epoch.fetch_add(1, std::memory_order_seq_cst), std::move(previous) });
+
+    reclaim();
+}
+
+
+void SharedDirectory::reclaim()
+{
+    std::uint64_t oldest { UINT64_MAX };
+
+    for (const Announcement& announcement : m_announcements)
+    {
+        if (std::uint64_t epoch { announcement.m_epoch.load(std::memory_order_seq_cst) }; epoch != 0)
+        {
+            oldest = std::min(oldest, epoch);
+        }
+    }
+
+    std::erase_if(m_retired, [oldest](const Retired& retired) { return retired.m_epoch < oldest; });
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * A directory file.
+ *
+ * Rebuilding a directory from text at every start parses every field, allocates two strings per employee and then hashes
+ * every name again, all to arrive at the same index as last time. A directory file stores the finished index instead,
+ * in a form that can be used exactly as it lies on disk:
+ *
+ * - A header, followed by one fixed-size record per employee, holding the offset and length of its name and address.
+ * - The hash table, built by writeDirectory() with the same layout and probing as EmployeeDirectory's, except that the
+ *   names are hashed with 64-bit FNV-1a. std::hash is only guaranteed to agree with itself within one run of a program,
+ *   and the file has to outlive that.
+ * - All the names and addresses, back to back, in one arena.
+ *
+ * MappedDirectory maps the file and validates the header, which takes the same time whatever the size of the file.
+ * FindAddress() then hashes the name and probes the table in place; the only pages it touches are one or two slots, one
+ * record and two strings, and the kernel reads them in on first use. The mapping is read-only and shared, so every
+ * process serving the same file shares one copy of it in the page cache.
+ *
+ * Since nothing but the header is validated up front, every offset is checked as it's used, and a file that doesn't
+ * add up throws rather than reading out of bounds. Files are written to a temporary name and renamed into place, so a
+ * directory that is being replaced can still be mapped and used until it's reopened.
+*/
+
+struct DirectoryHeader
+{
+    char m_magic[8];
+    std::uint32_t m_version;
+    std::uint32_t m_slots;                                  // A power of two
+    std::uint64_t m_count;                                  // Employees
+    std::uint64_t m_bytes;                                  // Size of the string arena
+};
+
+struct DirectoryRecord
+{
+    std::uint32_t m_name;                                   // Offsets into the string arena
+    std::uint32_t m_nameLength;
+    std::uint32_t m_address;
+    std::uint32_t m_addressLength;
+};
+
+struct DirectorySlot
+{
+    std::uint32_t m_record;                                 // Index + 1, 0 if the slot is empty
+    std::uint32_t m_tag;                                    // Upper half of the name's hash
+};
+
+constexpr char directoryMagic[8] { 'E', 'M', 'P', 'D', 'I', 'R', '\0', '\0' };
+constexpr std::uint32_t directoryVersion { 1 };
+
+
+constexpr std::uint64_t fnv1a(std::string_view text)
+{
+    std::uint64_t hash { 0xCBF2'9CE4'8422'2325 };
+
+    for (char c : text)
+    {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 0x0000'0100'0000'01B3;
+    }
+
+    return hash;
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Writing.
+ *
+ * The four sections are assembled in memory and written with one writev(), which may write less than asked for, to a
+ * temporary file that is fsync()ed and only then renamed over the old one. Like EmployeeDirectory, the index keeps the
+ * first employee of any name.
+*/
+
+void writeDirectory(const std::string& path, const std::vector<Employee>& employees)
+{
+    std::size_t tableSize { std::bit_ceil(std::max<std::size_t>(16, 2 * employees.size())) };
+
+    if (tableSize > UINT32_MAX)
+    {
+        throw("Directory too large.");
+    }
+
+    std::vector<DirectoryRecord> records(employees.size());
+    std::vector<DirectorySlot> slots(tableSize, DirectorySlot { 0, 0 });
+    std::string strings;
+
+    for (const Employee& employee : employees)
+    {
+        if (strings.size() + employee.m_name.size() + employee.m_address.size() > UINT32_MAX)
+        {
+            throw("Directory too large.");
+        }
+
+        strings.append(employee.m_name);
+        strings.append(employee.m_address);
+    }
+
+    std::size_t mask { slots.size() - 1 };
+
+    for (std::size_t i { 0 }, offset { 0 }; i < employees.size(); ++i)
+    {
+        const Employee& employee { employees[i] };
+        std::uint64_t hash { fnv1a(employee.m_name) };
+        std::uint32_t tag { static_cast<std::uint32_t>(hash >> 32) };
+
+        records[i] = { static_cast<std::uint32_t>(offset), static_cast<std::uint32_t>(employee.m_name.size()),
+                       static_cast<std::uint32_t>(offset + employee.m_name.size()),
+                       static_cast<std::uint32_t>(employee.m_address.size()) };
+        offset += employee.m_name.size() + employee.m_address.size();
+
+        std::size_t slot { hash & mask };
+
+        while (slots[slot].m_record != 0)
+        {
+            const DirectorySlot& taken { slots[slot] };
+
+            if (taken.m_tag == tag && employees[taken.m_record - 1].m_name == employee.m_name)
+            {
+                break;
+            }
+
+            slot = (slot + 1) & mask;
+        }
+
+        if (slots[slot].m_record == 0)
+        {
+            slots[slot] = { static_cast<std::uint32_t>(i + 1), tag };
+        }
+    }
+
+    DirectoryHeader header { { }, directoryVersion, static_cast<std::uint32_t>(slots.size()), employees.size(),
+                             strings.size() };
+
+    std::memcpy(header.m_magic, directoryMagic, sizeof(directoryMagic));
+
+    std::string temporary { path + ".tmp" };
+    int file { open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644) };
+
+    if (file < 0)
+    {
+        throw("Cannot create directory file.");
+    }
+
+    iovec parts[4]
+    {
+        { &header, sizeof(header) },
+        { records.data(), records.size() * sizeof(DirectoryRecord) },
+        { slots.data(), slots.size() * sizeof(DirectorySlot) },
+        { strings.data(), strings.size() }
+    };
+
+    int part { 0 };
+
+    while (part < 4)
+    {
+        ssize_t written { writev(file, parts + part, 4 - part) };
+
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            break;
+        }
+
+        while (part < 4 && static_cast<std::size_t>(written) >= parts[part].iov_len)
+        {
+            written -= parts[part].iov_len;
+            ++part;
+        }
+
+        if (part < 4)
+        {
+            parts[part].iov_base = static_cast<char*>(parts[part].iov_base) + written;
+            parts[part].iov_len -= written;
+        }
+    }
+
+    bool stored { part == 4 && fsync(file) == 0 };
+    stored = close(file) == 0 && stored;
+
+    if (!stored || std::rename(temporary.c_str(), path.c_str()) != 0)
+    {
+        unlink(temporary.c_str());
+        throw("Cannot write directory file.");
+    }
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Reading.
+ *
+ * Lookups land on scattered pages, so the mapping is advised as random access, which keeps the kernel from reading ahead
+ * pages nobody asked for. The views FindAddress() returns point into the mapping and are valid for as long as the
+ * MappedDirectory is.
+*/
+
+class MappedDirectory
+{
+    public:
+        explicit MappedDirectory(const std::string& path);
+        ~MappedDirectory();
+
+        // No copying allowed
+        MappedDirectory(const MappedDirectory& other) = delete;
+        MappedDirectory& operator = (const MappedDirectory& other) = delete;
+
+        std::size_t size() const;
+        std::optional<std::string_view> FindAddress(std::string_view name) const;
+
+    private:
+        std::string_view text(std::uint32_t offset, std::uint32_t length) const;
+
+        void* m_p_mapping;
+        std::size_t m_length;
+        const DirectoryHeader* m_p_header;
+        const DirectoryRecord* m_p_records;
+        const DirectorySlot* m_p_slots;
+        const char* m_p_strings;
+};
+
+
+MappedDirectory::MappedDirectory(const std::string& path)
+    : m_p_mapping { nullptr }, m_length { 0 }, m_p_header { nullptr }, m_p_records { nullptr }, m_p_slots { nullptr },
+      m_p_strings { nullptr }
+{
+    int file { open(path.c_str(), O_RDONLY | O_CLOEXEC) };
+
+    if (file < 0)
+    {
+        throw("Cannot open directory file.");
+    }
+
+    struct stat status { };
+    DirectoryHeader header { };
+
+    bool valid { fstat(file, &status) == 0 && pread(file, &header, sizeof(header), 0) == ssize_t { sizeof(header) } &&
+                 std::memcmp(header.m_magic, directoryMagic, sizeof(directoryMagic)) == 0 &&
+                 header.m_version == directoryVersion && std::has_single_bit(header.m_slots) &&
+                 header.m_count < header.m_slots && header.m_bytes <= UINT32_MAX &&
+                 static_cast<std::uint64_t>(status.st_size) == sizeof(header) + header.m_count * sizeof(DirectoryRecord) +
+                                                                header.m_slots * sizeof(DirectorySlot) + header.m_bytes };
+
+    if (!valid)
+    {
+        close(file);
+        throw("Not a directory file.");
+    }
+
+    m_length = static_cast<std::size_t>(status.st_size);
+    m_p_mapping = mmap(nullptr, m_length, PROT_READ, MAP_SHARED, file, 0);
+    close(file);
+
+    if (m_p_mapping == MAP_FAILED)
+    {
+        throw("Cannot map directory file.");
+    }
+
+    madvise(m_p_mapping, m_length, MADV_RANDOM);
+
+    const char* base { static_cast<const char*>(m_p_mapping) };
+
+    m_p_header = reinterpret_cast<const DirectoryHeader*>(base);
+    m_p_records = reinterpret_cast<const DirectoryRecord*>(base + sizeof(DirectoryHeader));
+    m_p_slots = reinterpret_cast<const DirectorySlot*>(m_p_records + m_p_header->m_count);
+    m_p_strings = reinterpret_cast<const char*>(m_p_slots + m_p_header->m_slots);
+}
+
+
+MappedDirectory::~MappedDirectory()
+{
+    munmap(m_p_mapping, m_length);
+}
+
+
+std::size_t MappedDirectory::size() const
+{
+    return m_p_header->m_count;
+}
+
+
+std::string_view MappedDirectory::text(std::uint32_t offset, std::uint32_t length) const
+{
+    if (offset > m_p_header->m_bytes || length > m_p_header->m_bytes - offset)
+    {
+        throw("Corrupt directory file.");
+    }
+
+    return { m_p_strings + offset, length };
+}
+
+
+std::optional<std::string_view> MappedDirectory::FindAddress(std::string_view name) const
+{
+    std::uint64_t hash { fnv1a(name) };
+    std::uint32_t tag { static_cast<std::uint32_t>(hash >> 32) };
+    std::size_t mask { m_p_header->m_slots - std::size_t { 1 } };
+
+    // The table always has an empty slot, but a corrupt one might not; never probe more than all of it
+    for (std::size_t i { hash & mask }, probes { 0 }; probes <= mask; i = (i + 1) & mask, ++probes)
+    {
+        const DirectorySlot& slot { m_p_slots[i] };
+
+        if (slot.m_record == 0)
+        {
+            break;
+        }
+
+        if (slot.m_record > m_p_header->m_count)
+        {
+            throw("Corrupt directory file.");
+        }
+
+        const DirectoryRecord& record { m_p_records[slot.m_record - 1] };
+
+        if (slot.m_tag == tag && text(record.m_name, record.m_nameLength) == name)
+        {
+            return text(record.m_address, record.m_addressLength);
+        }
+    }
+
+    return std::nullopt;
 }
\ No newline at end of file
@@ -1,13 +1,30 @@
 #include <algorithm>
+#include <atomic>
+#include <bit>
+#include <climits>
+#include <cstdint>
+#include <functional>
 #include <list>
+#include <optional>
+#include <span>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <unordered_map>
 #include <vector>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 /**
  * Item 07 - Using the Standard Library
 */
 
-class Employee;
+class Employee
+{
+    public:
+        std::string m_name;
+        std::string m_address;
+};
 
 /**
  * Effective reuse is an important part of good software engineering.
@@ -45,4 +62,346 @@ std::string FindAddress(const std::vector<Employee> employees, std::string_view
     }
 
     return "";
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Looking up many names at once.
+ *
+ * Calling FindAddress() once per name scans the whole vector once per name. When the names come in a batch, the library
+ * can turn that around: put the names in a std::unordered_map once, then make a single pass over the employees and look
+ * each of them up in the map. The cost drops from names × employees comparisons to one hash per employee, and the pass
+ * stops as soon as every name has been found.
+ *
+ * The map is keyed on std::string_view, so neither building nor probing it copies a name. A name asked for twice is
+ * looked up once. The results come back in the order of the names, as views into the employees, which stay valid for as
+ * long as the vector isn't modified.
+*/
+
+std::vector<std::optional<std::string_view>> FindAddresses(const std::vector<Employee>& employees,
+                                                           std::span<const std::string_view> names)
+{
+    std::vector<std::optional<std::string_view>> addresses(names.size());
+    std::vector<std::size_t> first(names.size());                   // Where each name was first asked for
+    std::unordered_map<std::string_view, std::size_t> pending;
+
+    pending.reserve(names.size());
+
+    for (std::size_t i { 0 }; i < names.size(); ++i)
+    {
+        first[i] = pending.try_emplace(names[i], i).first->second;
+    }
+
+    for (auto i { employees.cbegin() }, end { employees.cend() }; i != end && !pending.empty(); ++i)
+    {
+        if (auto name { pending.find(i->m_name) }; name != pending.end())
+        {
+            addresses[name->second] = i->m_address;
+            pending.erase(name);
+        }
+    }
+
+    for (std::size_t i { 0 }; i < names.size(); ++i)
+    {
+        addresses[i] = addresses[ first[i] ];
+    }
+
+    return addresses;
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Searching in parallel.
+ *
+ * Without an index, std::find() is the right tool, but it runs on one core. ParallelFindAddress() spreads the same scan
+ * over several threads and still returns the first match, exactly like std::find():
+ *
+ * - The vector is handed out in blocks of 4096 employees, in order, from a shared counter. Any thread that is free takes
+ *   the next block, so a slow thread never holds up the others.
+ * - A thread that finds a match records its index in first, unless an earlier match is already there, and stops.
+ * - A thread never starts a block that begins after first. Every block before it has been searched to the end, or up to
+ *   a match, so first ends up being the earliest match there is. Everything after it is cancelled, which is the point:
+ *   a name near the front is found about as fast as with std::find().
+ *
+ * Starting threads costs tens of microseconds, which is more than searching a small vector takes, so anything smaller
+ * than parallelThreshold is searched with std::find_if() on the calling thread. So is everything when only one thread
+ * is asked for, or hardware_concurrency() doesn't know better.
+*/
+
+constexpr std::size_t parallelThreshold { std::size_t { 1 } << 16 };
+constexpr std::size_t searchBlock { 4096 };
+
+std::optional<std::string_view> ParallelFindAddress(const std::vector<Employee>& employees, std::string_view name,
+                                                    std::size_t threads = std::thread::hardware_concurrency())
+{
+    auto matches { [name](const Employee& employee) noexcept { return employee.m_name == name; } };
+
+    if (employees.size() < parallelThreshold || threads < 2)
+    {
+        if (auto target { std::find_if(employees.cbegin(), employees.cend(), matches) }; target != employees.cend())
+        {
+            return target->m_address;
+        }
+
+        return std::nullopt;
+    }
+
+    std::atomic<std::size_t> next { 0 };
+    std::atomic<std::size_t> first { employees.size() };
+
+    auto search { [&]() noexcept
+    {
+        while (true)
+        {
+            std::size_t begin { next.fetch_add(searchBlock, std::memory_order_relaxed) };
+
+            if (begin >= first.load(std::memory_order_relaxed))
+            {
+                return;
+            }
+
+            auto end { employees.cbegin() + std::min(begin + searchBlock, employees.size()) };
+
+            if (auto target { std::find_if(employees.cbegin() + begin, end, matches) }; target != end)
+            {
+                std::size_t index { static_cast<std::size_t>(target - employees.cbegin()) };
+                std::size_t current { first.load(std::memory_order_relaxed) };
+
+                while (index < current && !first.compare_exchange_weak(current, index, std::memory_order_relaxed)) { }
+
+                return;
+            }
+        }
+    } };
+
+    std::vector<std::thread> workers;
+
+    try
+    {
+        workers.reserve(threads - 1);
+
+        while (workers.size() < threads - 1)
+        {
+            workers.emplace_back(search);
+        }
+    }
+    catch ( ... )
+    {
+        // Out of threads; search with the ones we have
+    }
+
+    search();
+
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+
+    if (std::size_t index { first.load(std::memory_order_relaxed) }; index < employees.size())
+    {
+        return employees[index].m_address;
+    }
+
+    return std::nullopt;
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * A columnar directory.
+ *
+ * A std::vector<Employee> holds two std::strings per employee, and unless a name is short enough for the small string
+ * optimization, comparing it means following a pointer to wherever the allocator put its characters. A scan over the
+ * names is mostly cache misses. EmployeeColumns stores the same data as a structure of arrays instead:
+ *
+ * - Every name goes into one contiguous arena, one after the other, and m_nameOffsets says where each one starts and
+ *   ends. The addresses get an arena and offsets of their own, so a scan over the names never pulls addresses into the
+ *   cache.
+ * - m_keys holds a 32-bit fingerprint of every name, taken from its hash, four bytes per employee.
+ *
+ * FindAddress() scans only the keys, comparing 64 of them at a time into a bitmask, eight per instruction with AVX2. Only
+ * the employees whose key matches, which apart from the one we want is about one in four billion, have their name
+ * compared. As with std::find(), the first match wins.
+ *
+ * Offsets are 32 bits, so each arena holds up to 4 GiB.
+*/
+
+class EmployeeColumns
+{
+    public:
+        EmployeeColumns() = default;
+        explicit EmployeeColumns(const std::vector<Employee>& employees);
+
+        std::size_t size() const;
+        void add(std::string_view name, std::string_view address);
+
+        std::string_view nameAt(std::size_t row) const;
+        std::string_view addressAt(std::size_t row) const;
+
+        std::optional<std::string_view> FindAddress(std::string_view name) const;
+
+    private:
+        static std::uint32_t key(std::string_view name);
+        static std::uint64_t matchWord(const std::uint32_t* keys, std::uint32_t key);
+
+        std::string m_names;
+        std::vector<std::uint32_t> m_nameOffsets { 0 };         // Row i is [ m_nameOffsets[i], m_nameOffsets[i + 1] )
+        std::vector<std::uint32_t> m_keys;
+        std::string m_addresses;
+        std::vector<std::uint32_t> m_addressOffsets { 0 };
+};
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Storage.
+ *
+ * add() appends to five containers; if any of them throws, the ones that already grew are cut back, so it gives the
+ * strong guarantee.
+*/
+
+EmployeeColumns::EmployeeColumns(const std::vector<Employee>& employees)
+{
+    std::size_t names { 0 };
+    std::size_t addresses { 0 };
+
+    for (const Employee& employee : employees)
+    {
+        names += employee.m_name.size();
+        addresses += employee.m_address.size();
+    }
+
+    m_names.reserve(names);
+    m_addresses.reserve(addresses);
+    m_nameOffsets.reserve(employees.size() + 1);
+    m_addressOffsets.reserve(employees.size() + 1);
+    m_keys.reserve(employees.size());
+
+    for (const Employee& employee : employees)
+    {
+        add(employee.m_name, employee.m_address);
+    }
+}
+
+
+std::size_t EmployeeColumns::size() const
+{
+    return m_keys.size();
+}
+
+
+void EmployeeColumns::add(std::string_view name, std::string_view address)
+{
+    if (name.size() > UINT32_MAX - m_names.size() || address.size() > UINT32_MAX - m_addresses.size())
+    {
+        throw("EmployeeColumns is full.");
+    }
+
+    std::size_t rows { m_keys.size() };
+    std::size_t names { m_names.size() };
+    std::size_t addresses { m_addresses.size() };
+
+    try
+    {
+        m_names.append(name);
+        m_addresses.append(address);
+        m_nameOffsets.push_back(static_cast<std::uint32_t>(m_names.size()));
+        m_addressOffsets.push_back(static_cast<std::uint32_t>(m_addresses.size()));
+        m_keys.push_back(key(name));
+    }
+    catch ( ... )
+    {
+        m_names.resize(names);
+        m_addresses.resize(addresses);
+        m_nameOffsets.resize(rows + 1);
+        m_addressOffsets.resize(rows + 1);
+        m_keys.resize(rows);
+
+        throw;
+    }
+}
+
+
+std::string_view EmployeeColumns::nameAt(std::size_t row) const
+{
+    std::uint32_t begin { m_nameOffsets[row] };
+
+    return std::string_view { m_names }.substr(begin, m_nameOffsets[row + 1] - begin);
+}
+
+
+std::string_view EmployeeColumns::addressAt(std::size_t row) const
+{
+    std::uint32_t begin { m_addressOffsets[row] };
+
+    return std::string_view { m_addresses }.substr(begin, m_addressOffsets[row + 1] - begin);
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Matching.
+ *
+ * The last, partial word of keys is matched on a padded copy, padded with a key that can't match.
+*/
+
+std::uint32_t EmployeeColumns::key(std::string_view name)
+{
+    return static_cast<std::uint32_t>(std::hash<std::string_view> { }(name) >> 32);
+}
+
+
+std::uint64_t EmployeeColumns::matchWord(const std::uint32_t* keys, std::uint32_t key)
+{
+    std::uint64_t word { 0 };
+
+#if defined(__AVX2__)
+    const __m256i wanted { _mm256_set1_epi32(static_cast<std::int32_t>(key)) };
+
+    for (int i { 0 }; i < 64; i += 8)
+    {
+        __m256i equal { _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i)), wanted) };
+
+        word |= std::uint64_t { static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(equal))) } << i;
+    }
+#else
+    for (int i { 0 }; i < 64; ++i)
+    {
+        word |= std::uint64_t { keys[i] == key } << i;
+    }
+#endif
+
+    return word;
+}
+
+
+std::optional<std::string_view> EmployeeColumns::FindAddress(std::string_view name) const
+{
+    std::uint32_t wanted { key(name) };
+
+    for (std::size_t row { 0 }; row < m_keys.size(); row += 64)
+    {
+        std::uint32_t padded[64];
+        const std::uint32_t* keys { m_keys.data() + row };
+
+        if (m_keys.size() - row < 64)
+        {
+            std::fill(std::copy(keys, m_keys.data() + m_keys.size(), padded), padded + 64, ~wanted);
+            keys = padded;
+        }
+
+        for (std::uint64_t candidates { matchWord(keys, wanted) }; candidates != 0; candidates &= candidates - 1)
+        {
+            std::size_t candidate { row + std::countr_zero(candidates) };
+
+            if (nameAt(candidate) == name)
+            {
+                return addressAt(candidate);
+            }
+        }
+    }
+
+    return std::nullopt;
 }
\ No newline at end of file
@@ -1,6 +1,10 @@
+#include <cassert>
 #include <cstddef>
-#include <utility>
+#include <memory>
+#include <new>
 #include <stack>
+#include <type_traits>
+#include <utility>
 /**
  * Item 10 - Writing Exception-Safe Code - Part 3
  *
@@ -150,6 +154,247 @@ void Stack<T>::pop()
 
 template <class T>
 bool Stack<T>::empty() const
+{
+    return m_used == 0;
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Uninitialized storage.
+ *
+ * newCopy() does "new T[destSize]" and then assigns, so every growth default-constructs the whole new buffer only to
+ * overwrite half of it straight away. Worse, it's the reason Item 11 has to require T to be default-constructible and
+ * copy-assignable at all.
+ *
+ * newRawCopy() allocates raw memory instead and copy-constructs into it with std::uninitialized_copy(). The buffer then
+ * holds exactly m_used constructed objects, like StackImpl's does in Item 12, and a growth constructs each surviving
+ * element once. All T needs is a copy constructor and a destructor that doesn't throw.
+ *
+ * std::uninitialized_copy() already gives us the rollback we wrote by hand before: if one of the copies throws, it
+ * destroys the ones it has made and rethrows. All that's left for newRawCopy() to clean up is the raw memory.
+*/
+
+template <class T>
+T* newRawCopy(const T* source, std::size_t sourceSize, std::size_t destSize)
+{
+    assert(destSize >= sourceSize);
+
+    T* dest { static_cast<T*>(operator new(sizeof(T) * destSize)) };
+
+    try
+    {
+        std::uninitialized_copy(source, source + sourceSize, dest);
+    }
+    catch ( ... )
+    {
+        operator delete(dest);
+        throw;
+    }
+
+    return dest;
+}
+
+
+/**
+ * When the old buffer is about to be thrown away anyway, its elements can be moved instead of copied. But a move that
+ * throws halfway leaves the old buffer with some elements already moved out, so we could no longer roll back. Only move
+ * when T promises not to throw, exactly as std::vector does; otherwise fall back to copying.
+*/
+template <class T>
+void uninitializedRelocate(T* source, std::size_t sourceSize, T* dest)
+{
+    if constexpr (std::is_nothrow_move_constructible_v<T>)
+    {
+        std::uninitialized_move(source, source + sourceSize, dest);
+    }
+    else
+    {
+        std::uninitialized_copy(source, source + sourceSize, dest);
+    }
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * The Stack on uninitialized storage.
+ *
+ * RawStack has the same interface as Stack. The differences are all in the bookkeeping:
+ *
+ * - Only [ 0, m_used ) is constructed, so the copy functions copy m_used elements, not m_size.
+ * - The destructor and copy assignment destroy exactly the constructed elements before freeing the raw memory.
+ * - pop() has to destroy the element it removes, because unused space must not hold constructed objects.
+ * - An empty RawStack doesn't allocate at all.
+*/
+
+template <class T>
+class RawStack
+{
+    public:
+        RawStack() noexcept;
+        ~RawStack() noexcept;
+
+        RawStack(const RawStack& other);
+        RawStack& operator = (const RawStack& other);
+
+        std::size_t count() const;
+        void push(const T& element);
+        const T& top() const;
+        T& top();
+        void pop();
+        bool empty() const;
+
+    private:
+        static void release(T* buffer, std::size_t used) noexcept;
+
+        T* m_v;
+        std::size_t m_size;
+        std::size_t m_used;
+};
+
+
+template <class T>
+void RawStack<T>::release(T* buffer, std::size_t used) noexcept
+{
+    std::destroy(buffer, buffer + used);
+    operator delete(buffer);
+}
+
+
+template <class T>
+RawStack<T>::RawStack() noexcept
+    : m_v { nullptr }, m_size { 0 }, m_used { 0 } { }
+
+
+template <class T>
+RawStack<T>::~RawStack() noexcept
+{
+    release(m_v, m_used);
+}
+
+
+template <class T>
+RawStack<T>::RawStack(const RawStack& other)
+    : m_v { newRawCopy(other.m_v, other.m_used, other.m_size) }, m_size { other.m_size }, m_used { other.m_used } { }
+
+
+template <class T>
+RawStack<T>& RawStack<T>::operator = (const RawStack& other)
+{
+    if (this != &other)
+    {
+        T* newObject { newRawCopy(other.m_v, other.m_used, other.m_size) };
+
+        release(m_v, m_used);
+
+        m_v = newObject;
+        m_size = other.m_size;
+        m_used = other.m_used;
+    }
+
+    return *this;
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * push().
+ *
+ * On growth, the new element goes into the new buffer first, and only then are the old elements relocated behind it. That
+ * order buys us two things:
+ *
+ * - If the new element's copy constructor throws, nothing has been moved yet and all we have to free is raw memory.
+ * - "s.push(s.top())" is safe, because element may refer into the old buffer, which is still untouched when we copy it.
+ *
+ * If relocating throws, it can only be because we're copying, so the old buffer is intact and the Stack is unchanged.
+*/
+
+template <class T>
+void RawStack<T>::push(const T& element)
+{
+    if (m_used == m_size)
+    {
+        std::size_t newSize { m_size * 2 + 1 };
+        T* m_vNew { static_cast<T*>(operator new(sizeof(T) * newSize)) };
+
+        try
+        {
+            new (m_vNew + m_used) T(element);
+        }
+        catch ( ... )
+        {
+            operator delete(m_vNew);
+            throw;
+        }
+
+        try
+        {
+            uninitializedRelocate(m_v, m_used, m_vNew);
+        }
+        catch ( ... )
+        {
+            std::destroy_at(m_vNew + m_used);
+            operator delete(m_vNew);
+            throw;
+        }
+
+        release(m_v, m_used);
+
+        m_v = m_vNew;
+        m_size = newSize;
+    }
+    else
+    {
+        new (m_v + m_used) T(element);
+    }
+
+    ++m_used;
+}
+
+
+template <class T>
+std::size_t RawStack<T>::count() const
+{
+    return m_used;
+}
+
+
+template <class T>
+const T& RawStack<T>::top() const
+{
+    if (m_used == 0)
+    {
+        throw("Empty Stack");
+    }
+
+    return m_v[m_used - 1];
+}
+
+
+template <class T>
+T& RawStack<T>::top()
+{
+    return const_cast<T&>(std::as_const(*this).top());
+}
+
+
+template <class T>
+void RawStack<T>::pop()
+{
+    if (m_used == 0)
+    {
+        throw("Popping from empty stack.");
+    }
+    else
+    {
+        --m_used;
+        std::destroy_at(m_v + m_used);
+    }
+}
+
+
+template <class T>
+bool RawStack<T>::empty() const
 {
     return m_used == 0;
 }
\ No newline at end of file
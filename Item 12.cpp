@@ -1,5 +1,18 @@
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <type_traits>
 #include <utility>
+#include <vector>
+#include <sys/mman.h>
 /**
  * Item 12 - Writing Exception-Safe Code - Part 5
 */
@@ -42,7 +55,7 @@ class StackImpl
 
 template <class T>
 StackImpl<T>::StackImpl(std::size_t size)
-    : m_v { static_cast<T*>(size == 0 ? 0 : new(sizeof(T) * size)) }, m_size { size }, m_used { 0 } { }
+    : m_v { static_cast<T*>(size == 0 ? 0 : operator new(sizeof(T) * size)) }, m_size { size }, m_used { 0 } { }
 
 /* -------------------------------------------------------------------------------------------------------------------- */
 
@@ -76,11 +89,156 @@ void destroy(ForwardIterator first, ForwardIterator last)
     }
 }
 
+/**
+ * Bulk helpers.
+ *
+ * Tearing down a StackImpl of 50 million strings one destructor at a time takes seconds, and every destructor is
+ * independent of the others. destroyBulk() and copyBulk() work on whole contiguous ranges instead:
+ *
+ * - For trivially destructible T, destroyBulk() compiles to nothing at all, instead of relying on the optimizer to throw
+ *   away an empty loop. For trivially copyable T, copyBulk() is a single memmove().
+ * - Ranges of at least two bulkThreshold elements are split into one chunk per hardware thread, and the chunks are
+ *   processed concurrently. Starting a thread costs tens of microseconds, which the threshold comfortably amortizes.
+ * - Below the threshold, they're the plain serial loops.
+ *
+ * destroyBulk() is noexcept like any destruction: if a thread can't be started, its chunk simply runs on the calling
+ * thread. copyBulk() gives the strong guarantee. Each chunk rolls itself back if one of its copies throws, and once every
+ * chunk has finished, the chunks that did succeed are destroyed and the first exception is rethrown.
+ *
+ * Their users here are StackImpl's destructor below, and MappedStackImpl's destructor and MappedStack's copy constructor
+ * further down. Items 13 and 14 carry their own copies for their StackImpl destructors and Stack copy constructors.
+*/
+
+constexpr std::size_t bulkThreshold { std::size_t { 1 } << 16 };
+
+
+std::size_t bulkChunks(std::size_t count)
+{
+    if (count < 2 * bulkThreshold)
+    {
+        return 1;
+    }
+
+    return std::min<std::size_t>(std::max(1u, std::thread::hardware_concurrency()), count / bulkThreshold);
+}
+
+
+std::size_t chunkBegin(std::size_t count, std::size_t chunks, std::size_t chunk)
+{
+    return count / chunks * chunk + std::min(chunk, count % chunks);
+}
+
+
+// Calls function(chunk, begin, end) for every chunk of [ 0, count ), the first on the calling thread
+template <class Function>
+void forChunks(std::size_t count, std::size_t chunks, Function function) noexcept
+{
+    std::vector<std::thread> threads;
+    std::size_t chunk { 1 };
+
+    try
+    {
+        threads.reserve(chunks - 1);
+
+        for ( ; chunk < chunks; ++chunk)
+        {
+            threads.emplace_back(function, chunk, chunkBegin(count, chunks, chunk), chunkBegin(count, chunks, chunk + 1));
+        }
+    }
+    catch ( ... )
+    {
+        // Out of threads; whatever wasn't handed out runs here
+    }
+
+    function(0, 0, chunkBegin(count, chunks, 1));
+
+    for ( ; chunk < chunks; ++chunk)
+    {
+        function(chunk, chunkBegin(count, chunks, chunk), chunkBegin(count, chunks, chunk + 1));
+    }
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+
+template <class T>
+void destroyBulk(T* first, T* last) noexcept
+{
+    if constexpr (!std::is_trivially_destructible_v<T>)
+    {
+        std::size_t count ( last - first );
+        std::size_t chunks { bulkChunks(count) };
+
+        if (chunks == 1)
+        {
+            ::destroy(first, last);
+
+            return;
+        }
+
+        forChunks(count, chunks, [first](std::size_t, std::size_t begin, std::size_t end) noexcept
+        {
+            ::destroy(first + begin, first + end);
+        });
+    }
+}
+
+
+template <class T>
+void copyBulk(const T* first, const T* last, T* destination)
+{
+    std::size_t count ( last - first );
+    std::size_t chunks { std::is_trivially_copyable_v<T> ? 1 : bulkChunks(count) };
+
+    if (chunks == 1)
+    {
+        std::uninitialized_copy(first, last, destination);
+
+        return;
+    }
+
+    std::vector<std::exception_ptr> failures(chunks);
+
+    forChunks(count, chunks, [=, &failures](std::size_t chunk, std::size_t begin, std::size_t end) noexcept
+    {
+        try
+        {
+            std::uninitialized_copy(first + begin, first + end, destination + begin);
+        }
+        catch ( ... )
+        {
+            failures[chunk] = std::current_exception();
+        }
+    });
+
+    auto failure { std::find_if(failures.begin(), failures.end(), [](const std::exception_ptr& p) { return p; }) };
+
+    if (failure != failures.end())
+    {
+        for (std::size_t chunk { 0 }; chunk < chunks; ++chunk)
+        {
+            if (!failures[chunk])
+            {
+                std::size_t begin { chunkBegin(count, chunks, chunk) };
+                std::size_t end { chunkBegin(count, chunks, chunk + 1) };
+
+                ::destroy(destination + begin, destination + end);
+            }
+        }
+
+        std::rethrow_exception(*failure);
+    }
+}
+
+
 template <class T>
 StackImpl<T>::~StackImpl()
 {
-    destroy(m_v, m_v + m_used);
-    delete m_v;
+    destroyBulk(m_v, m_v + m_used);
+    operator delete(m_v);
 }
 
 /* -------------------------------------------------------------------------------------------------------------------- */
@@ -123,4 +281,793 @@ void StackImpl<T>::swap(StackImpl& other) noexcept
  * Using public hints that StackImpl is intended to be used as a struct by some external client, because its data members
  * are public. So again, Stack will be "implemented in terms of " StackImpl, only this time using a HAS-A containment
  * relationship instead of private inheritance.
-*/
\ No newline at end of file
+*/
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Work-stealing deque.
+ *
+ * The same split between raw memory (StackImpl) and the objects living in it (construct() / destroy()) also gives us a
+ * Chase-Lev work-stealing deque. One owner thread pushes and pops LIFO at the bottom, exactly like a Stack, while any
+ * number of thieves steal FIFO from the top. Only the last element is contended; everything else is uncontended loads and
+ * stores.
+ *
+ * The deque is meant for small, trivially copyable handles such as Task*. A thief reads a slot before it knows whether it
+ * has won the race for it, so reading must never be able to throw or observe a half-constructed object.
+*/
+
+template <class T>
+class DequeImpl
+{
+    public:
+        DequeImpl(std::size_t size);
+        ~DequeImpl();
+
+        // No copying allowed
+        DequeImpl(const DequeImpl& other) = delete;
+        DequeImpl& operator = (const DequeImpl& other) = delete;
+
+        T get(std::int64_t index) const noexcept;
+        void put(std::int64_t index, T value) noexcept;
+
+        std::atomic<T>* m_v;
+        std::size_t m_size;                                     // Always a power of two
+};
+
+template <class T>
+class WorkStealingDeque
+{
+    static_assert(std::is_trivially_copyable_v<T>, "Thieves copy slots they may not win, so T must be trivially copyable");
+
+    public:
+        WorkStealingDeque(std::size_t size = 64);
+        ~WorkStealingDeque();
+
+        WorkStealingDeque(const WorkStealingDeque& other) = delete;
+        WorkStealingDeque& operator = (const WorkStealingDeque& other) = delete;
+
+        // Owner thread only
+        void push(T element);
+        std::optional<T> pop();
+
+        // Any thread
+        std::optional<T> steal();
+
+    private:
+        DequeImpl<T>* grow(DequeImpl<T>* impl, std::int64_t top, std::int64_t bottom);
+
+        std::atomic<std::int64_t> m_top;
+        std::atomic<std::int64_t> m_bottom;
+        std::atomic<DequeImpl<T>*> m_impl;
+
+        // A thief may still be reading from a buffer after the owner has outgrown it, so old buffers live until the deque
+        // itself dies
+        std::vector<std::unique_ptr<DequeImpl<T>>> m_retired;
+};
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * DequeImpl.
+ *
+ * Just like StackImpl, DequeImpl owns raw memory and nothing else. The one difference is that every slot is constructed up
+ * front, because a thief is allowed to read any slot at any time and an std::atomic must be alive to be read.
+ *
+ * The calls to destroy() are qualified, because for std::atomic arguments argument-dependent lookup would also find
+ * std::destroy() and the call would be ambiguous.
+*/
+
+template <class T>
+DequeImpl<T>::DequeImpl(std::size_t size)
+    : m_v { static_cast<std::atomic<T>*>(operator new(sizeof(std::atomic<T>) * size)) }, m_size { size }
+{
+    // std::atomic<T> construction can't throw, so there's no partially constructed buffer to clean up
+    for (std::size_t i { 0 }; i < m_size; ++i)
+    {
+        construct(m_v + i, T { });
+    }
+}
+
+
+template <class T>
+DequeImpl<T>::~DequeImpl()
+{
+    ::destroy(m_v, m_v + m_size);
+    operator delete(m_v);
+}
+
+
+template <class T>
+T DequeImpl<T>::get(std::int64_t index) const noexcept
+{
+    return m_v[static_cast<std::size_t>(index) & (m_size - 1)].load(std::memory_order_relaxed);
+}
+
+
+template <class T>
+void DequeImpl<T>::put(std::int64_t index, T value) noexcept
+{
+    m_v[static_cast<std::size_t>(index) & (m_size - 1)].store(value, std::memory_order_relaxed);
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Constructor, destructor and growth.
+ *
+ * grow() follows the same recipe as Stack::push() in Item 13: do all the work that might throw off to the side, and only
+ * then publish the result with operations that can't throw. If the new buffer can't be allocated, or there is no room to
+ * remember the old one, the deque is unchanged.
+*/
+
+template <class T>
+WorkStealingDeque<T>::WorkStealingDeque(std::size_t size)
+    : m_top { 0 }, m_bottom { 0 }, m_impl { new DequeImpl<T> { std::bit_ceil(std::max<std::size_t>(size, 2)) } } { }
+
+
+template <class T>
+WorkStealingDeque<T>::~WorkStealingDeque()
+{
+    delete m_impl.load(std::memory_order_relaxed);
+}
+
+
+template <class T>
+DequeImpl<T>* WorkStealingDeque<T>::grow(DequeImpl<T>* impl, std::int64_t top, std::int64_t bottom)
+{
+    std::unique_ptr<DequeImpl<T>> bigger { new DequeImpl<T> { impl->m_size * 2 } };
+
+    for (std::int64_t i { top }; i < bottom; ++i)
+    {
+        bigger->put(i, impl->get(i));
+    }
+
+    m_retired.emplace_back(nullptr);
+
+    // Nothing below can throw
+    m_retired.back().reset(impl);
+    m_impl.store(bigger.get(), std::memory_order_release);
+
+    return bigger.release();
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * push() and pop().
+ *
+ * The owner works at the bottom without any read-modify-write operations. pop() has to race against thieves only when it
+ * takes the last element, and it settles that race with the same compare-exchange on m_top that steal() uses.
+*/
+
+template <class T>
+void WorkStealingDeque<T>::push(T element)
+{
+    std::int64_t bottom { m_bottom.load(std::memory_order_relaxed) };
+    std::int64_t top { m_top.load(std::memory_order_acquire) };
+    DequeImpl<T>* impl { m_impl.load(std::memory_order_relaxed) };
+
+    if (bottom - top > static_cast<std::int64_t>(impl->m_size) - 1)
+    {
+        impl = grow(impl, top, bottom);
+    }
+
+    impl->put(bottom, element);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_bottom.store(bottom + 1, std::memory_order_relaxed);
+}
+
+
+template <class T>
+std::optional<T> WorkStealingDeque<T>::pop()
+{
+    std::int64_t bottom { m_bottom.load(std::memory_order_relaxed) - 1 };
+    DequeImpl<T>* impl { m_impl.load(std::memory_order_relaxed) };
+
+    m_bottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    std::int64_t top { m_top.load(std::memory_order_relaxed) };
+
+    if (top > bottom)
+    {
+        // Empty
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+
+        return std::nullopt;
+    }
+
+    std::optional<T> element { impl->get(bottom) };
+
+    if (top == bottom)
+    {
+        // The last element: whoever moves m_top first gets it
+        if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            element.reset();
+        }
+
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+
+    return element;
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * steal().
+ *
+ * A thief reads the oldest element and then tries to claim it by advancing m_top. If the compare-exchange fails, someone
+ * else got there first and the value read is simply dropped; that's why T must be trivially copyable.
+*/
+
+template <class T>
+std::optional<T> WorkStealingDeque<T>::steal()
+{
+    std::int64_t top { m_top.load(std::memory_order_acquire) };
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::int64_t bottom { m_bottom.load(std::memory_order_acquire) };
+
+    if (top >= bottom)
+    {
+        return std::nullopt;
+    }
+
+    T element { m_impl.load(std::memory_order_acquire)->get(top) };
+
+    if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+    {
+        return std::nullopt;
+    }
+
+    return element;
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * A small fork-join scheduler.
+ *
+ * Each worker owns one WorkStealingDeque<Task*> and treats it as its private Stack. A worker with nothing to do steals from
+ * the others. The thread that calls run() becomes worker 0 for the duration of the call, so the root task needs no special
+ * injection queue.
+ *
+ * Tasks don't own each other. A parent keeps its children on its own stack frame and calls wait() before returning, and
+ * wait() runs other tasks instead of blocking, so no worker ever sleeps on a join.
+*/
+
+class Scheduler;
+
+class Task
+{
+    public:
+        virtual ~Task() = default;
+        virtual void run(Scheduler& scheduler) = 0;
+
+        std::atomic<std::size_t>* m_p_join { nullptr };         // Decremented when run() has finished
+};
+
+class Scheduler
+{
+    public:
+        Scheduler(std::size_t threads = std::max(1u, std::thread::hardware_concurrency()));
+        ~Scheduler();
+
+        Scheduler(const Scheduler& other) = delete;
+        Scheduler& operator = (const Scheduler& other) = delete;
+
+        void run(Task& root);
+        void spawn(Task& task);
+        void wait(const std::atomic<std::size_t>& pending);
+
+    private:
+        bool runOne();
+        void execute(Task* task);
+
+        std::vector<std::unique_ptr<WorkStealingDeque<Task*>>> m_deques;
+        std::vector<std::thread> m_threads;
+        std::atomic<bool> m_done;
+
+        static thread_local std::size_t t_index;
+};
+
+thread_local std::size_t Scheduler::t_index { 0 };
+
+
+Scheduler::Scheduler(std::size_t threads)
+    : m_done { false }
+{
+    for (std::size_t i { 0 }; i < threads; ++i)
+    {
+        m_deques.push_back(std::make_unique<WorkStealingDeque<Task*>>());
+    }
+
+    try
+    {
+        for (std::size_t i { 1 }; i < threads; ++i)
+        {
+            m_threads.emplace_back([this, i]
+            {
+                t_index = i;
+
+                while (!m_done.load(std::memory_order_acquire))
+                {
+                    if (!runOne())
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+    }
+    catch ( ... )
+    {
+        // The destructor won't run for a half-built Scheduler, so stop the threads we did start
+        m_done.store(true, std::memory_order_release);
+
+        for (std::thread& thread : m_threads)
+        {
+            thread.join();
+        }
+
+        throw;
+    }
+}
+
+
+Scheduler::~Scheduler()
+{
+    m_done.store(true, std::memory_order_release);
+
+    for (std::thread& thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+
+void Scheduler::run(Task& root)
+{
+    t_index = 0;
+    execute(&root);
+}
+
+
+void Scheduler::spawn(Task& task)
+{
+    m_deques[t_index]->push(&task);
+}
+
+
+void Scheduler::wait(const std::atomic<std::size_t>& pending)
+{
+    while (pending.load(std::memory_order_acquire) != 0)
+    {
+        if (!runOne())
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+
+bool Scheduler::runOne()
+{
+    if (std::optional<Task*> task { m_deques[t_index]->pop() })
+    {
+        execute(*task);
+
+        return true;
+    }
+
+    for (std::size_t i { 1 }; i < m_deques.size(); ++i)
+    {
+        if (std::optional<Task*> task { m_deques[(t_index + i) % m_deques.size()]->steal() })
+        {
+            execute(*task);
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+void Scheduler::execute(Task* task)
+{
+    task->run(*this);
+
+    if (task->m_p_join)
+    {
+        task->m_p_join->fetch_sub(1, std::memory_order_release);
+    }
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Memory-mapped storage for very large stacks.
+ *
+ * A StackImpl that holds hundreds of millions of elements pays twice for every growth: the copy into the new buffer, and
+ * a page fault for every fresh page of it. The TLB doesn't enjoy a buffer that size either.
+ *
+ * On a 64-bit system, address space is cheap. MappedStackImpl reserves a big virtual range up front with mmap(), without
+ * any memory behind it, and commits pages from the front of it as the stack grows. Growing is then just mprotect() on the
+ * next stretch of the same range, so the elements never move. The range is aligned to 2 MiB and marked MADV_HUGEPAGE, so
+ * the kernel can back it with transparent huge pages where it's allowed to.
+ *
+ * Cheap isn't free, though: the kernel limits how many mappings a process may have, and every mapping commits at least a
+ * huge page. So only buffers that are big to begin with get mapped. Unless the caller asks for a reservation of its own,
+ * a buffer of mappingThreshold bytes or more reserves headroom times its size, and anything smaller, including every empty
+ * stack, gets the ordinary heap buffer. A stack that starts small moves to a mapping when it grows past the threshold.
+ *
+ * If reserving or committing fails, MappedStackImpl quietly falls back to the heap buffer too, and extend() reports that
+ * it can't grow in place, so the owner grows the usual way.
+*/
+
+template <class T>
+class MappedStackImpl
+{
+    public:
+        static constexpr std::size_t hugePage { std::size_t { 1 } << 21 };
+        static constexpr std::size_t mappingThreshold { std::size_t { 1 } << 26 };  // 64 MiB
+        static constexpr std::size_t headroom { 16 };                               // Reservation per byte requested
+
+        MappedStackImpl(std::size_t size = 0, std::size_t reservation = 0);
+        ~MappedStackImpl();
+
+        // No copying allowed
+        MappedStackImpl(const MappedStackImpl& other) = delete;
+        MappedStackImpl& operator = (const MappedStackImpl& other) = delete;
+
+        void swap(MappedStackImpl& other) noexcept;
+        bool extend(std::size_t size) noexcept;
+
+        T* m_v;
+        std::size_t m_size;
+        std::size_t m_used;
+
+    private:
+        static std::size_t roundUp(std::size_t bytes, std::size_t granularity) noexcept;
+
+        bool map(std::size_t size, std::size_t reservation) noexcept;
+
+        std::size_t m_reserved;                                 // Bytes of address space; 0 if the buffer is on the heap
+};
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Constructor and destructor.
+ *
+ * A reservation of 0 means "pick one". map() reserves the range and commits the initial size; mmap() only promises page
+ * alignment, so it reserves one extra huge page and trims the ragged ends off again. If the initial size can't be
+ * committed, there's no point keeping the reservation, and the constructor takes the heap path as if nothing had been
+ * mapped. Only operator new() can make it throw.
+*/
+
+template <class T>
+std::size_t MappedStackImpl<T>::roundUp(std::size_t bytes, std::size_t granularity) noexcept
+{
+    return (bytes + granularity - 1) / granularity * granularity;
+}
+
+
+template <class T>
+MappedStackImpl<T>::MappedStackImpl(std::size_t size, std::size_t reservation)
+    : m_v { nullptr }, m_size { 0 }, m_used { 0 }, m_reserved { 0 }
+{
+    std::size_t bytes { sizeof(T) * size };
+
+    if (reservation == 0 && bytes >= mappingThreshold && bytes <= SIZE_MAX / headroom)
+    {
+        reservation = headroom * bytes;
+    }
+
+    if (reservation == 0 || !map(size, std::max(reservation, bytes)))
+    {
+        // The heap path: exactly StackImpl's buffer
+        m_v = static_cast<T*>(size == 0 ? nullptr : operator new(bytes));
+        m_size = size;
+    }
+}
+
+
+template <class T>
+bool MappedStackImpl<T>::map(std::size_t size, std::size_t reservation) noexcept
+{
+    if (reservation > SIZE_MAX - 2 * hugePage)
+    {
+        return false;
+    }
+
+    reservation = roundUp(reservation, hugePage);
+
+    void* mapped { mmap(nullptr, reservation + hugePage, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0) };
+
+    if (mapped == MAP_FAILED)
+    {
+        return false;
+    }
+
+    char* begin { static_cast<char*>(mapped) };
+    char* aligned { begin + (hugePage - reinterpret_cast<std::uintptr_t>(begin) % hugePage) % hugePage };
+
+    if (aligned != begin)
+    {
+        munmap(begin, aligned - begin);
+    }
+
+    munmap(aligned + reservation, begin + hugePage - aligned);
+    madvise(aligned, reservation, MADV_HUGEPAGE);       // Just a hint; fails harmlessly where THP is disabled
+
+    m_v = reinterpret_cast<T*>(aligned);
+    m_reserved = reservation;
+
+    if (!extend(size))
+    {
+        munmap(aligned, reservation);
+
+        m_v = nullptr;
+        m_reserved = 0;
+
+        return false;
+    }
+
+    return true;
+}
+
+
+template <class T>
+MappedStackImpl<T>::~MappedStackImpl()
+{
+    destroyBulk(m_v, m_v + m_used);
+
+    if (m_reserved != 0)
+    {
+        munmap(m_v, m_reserved);
+    }
+    else
+    {
+        operator delete(m_v);
+    }
+}
+
+
+template <class T>
+void MappedStackImpl<T>::swap(MappedStackImpl& other) noexcept
+{
+    std::swap(m_v, other.m_v);
+    std::swap(m_size, other.m_size);
+    std::swap(m_used, other.m_used);
+    std::swap(m_reserved, other.m_reserved);
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * extend().
+ *
+ * Makes room for at least size elements without moving any of them. Pages are committed a huge page at a time, so the
+ * kernel has whole 2 MiB extents to back with huge pages, and so we don't call mprotect() once per 4 KiB page. Committed
+ * memory costs nothing until it's touched; pages are still only faulted in as elements are constructed on them.
+ *
+ * extend() never throws and never changes anything if it fails. It fails when the buffer is on the heap, when the
+ * reservation is exhausted, or when the kernel won't commit more memory.
+*/
+
+template <class T>
+bool MappedStackImpl<T>::extend(std::size_t size) noexcept
+{
+    if (size <= m_size)
+    {
+        return true;
+    }
+
+    if (m_reserved == 0 || size > m_reserved / sizeof(T))
+    {
+        return false;
+    }
+
+    char* base { reinterpret_cast<char*>(m_v) };
+    std::size_t committed { roundUp(sizeof(T) * m_size, hugePage) };
+    std::size_t wanted { std::min(roundUp(sizeof(T) * size, hugePage), m_reserved) };
+
+    if (wanted > committed && mprotect(base + committed, wanted - committed, PROT_READ | PROT_WRITE) != 0)
+    {
+        return false;
+    }
+
+    m_size = wanted / sizeof(T);
+
+    return true;
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Using it.
+ *
+ * This is Item 13's Stack on a MappedStackImpl. The only change is in push(): try to grow in place first, and fall back to
+ * the copy-and-swap growth only when that fails. Growing in place moves nothing and can't throw, so the strong guarantee
+ * comes for free.
+*/
+
+template <class T>
+class MappedStack : private MappedStackImpl<T>
+{
+    public:
+        MappedStack(std::size_t size = 0);
+
+        MappedStack(const MappedStack& other);
+        MappedStack& operator = (const MappedStack& other);
+
+        std::size_t count() const;
+        void push(const T& element);
+        T& top();
+        void pop();
+
+    private:
+        using MappedStackImpl<T>::m_v;
+        using MappedStackImpl<T>::m_size;
+        using MappedStackImpl<T>::m_used;
+};
+
+
+template <class T>
+MappedStack<T>::MappedStack(std::size_t size)
+    : MappedStackImpl<T> { size } { }
+
+
+template <class T>
+MappedStack<T>::MappedStack(const MappedStack& other)
+    : MappedStackImpl<T> { other.m_used }
+{
+    copyBulk(other.m_v, other.m_v + other.m_used, m_v);
+    m_used = other.m_used;
+}
+
+
+template <class T>
+MappedStack<T>& MappedStack<T>::operator = (const MappedStack& other)
+{
+    MappedStack temp { other };
+    this->swap(temp);
+
+    return *this;
+}
+
+
+template <class T>
+std::size_t MappedStack<T>::count() const
+{
+    return m_used;
+}
+
+
+template <class T>
+void MappedStack<T>::push(const T& element)
+{
+    if (m_used == m_size && !this->extend(m_size * 2 + 1))
+    {
+        MappedStack temp { m_size * 2 + 1 };
+
+        while (temp.count() < m_used)
+        {
+            temp.push(m_v[ temp.count() ]);
+        }
+
+        temp.push(element);
+        this->swap(temp);
+
+        return;
+    }
+
+    construct(m_v + m_used, element);
+    ++m_used;
+}
+
+
+template <class T>
+T& MappedStack<T>::top()
+{
+    if (m_used == 0)
+    {
+        throw("Empty Stack");
+    }
+
+    return m_v[m_used - 1];
+}
+
+
+template <class T>
+void MappedStack<T>::pop()
+{
+    if (m_used == 0)
+    {
+        throw("Pop from an empty stack.");
+    }
+    else
+    {
+        --m_used;
+        destroy(m_v + m_used);
+    }
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Fork-join benchmark.
+ *
+ * The classic recursive Fibonacci: every call forks one child, computes the other half itself and joins. It does almost no
+ * work per task, so it measures the scheduler and the deque rather than the arithmetic. Below the cutoff we fall back to
+ * plain recursion, as any real fork-join program would.
+*/
+
+std::uint64_t fibonacci(unsigned number)
+{
+    return number < 2 ? number : fibonacci(number - 1) + fibonacci(number - 2);
+}
+
+class FibonacciTask : public Task
+{
+    public:
+        FibonacciTask(unsigned number, std::uint64_t& result)
+            : m_number { number }, m_result { result } { }
+
+        void run(Scheduler& scheduler) override
+        {
+            if (m_number < 20)
+            {
+                m_result = fibonacci(m_number);
+
+                return;
+            }
+
+            std::uint64_t left { 0 };
+            std::uint64_t right { 0 };
+            std::atomic<std::size_t> pending { 1 };
+
+            FibonacciTask child { m_number - 1, left };
+            child.m_p_join = &pending;
+            scheduler.spawn(child);
+
+            FibonacciTask { m_number - 2, right }.run(scheduler);
+            scheduler.wait(pending);
+
+            m_result = left + right;
+        }
+
+    private:
+        unsigned m_number;
+        std::uint64_t& m_result;
+};
+
+
+int main()
+{
+    constexpr unsigned number { 36 };
+
+    auto start { std::chrono::steady_clock::now() };
+    std::uint64_t expected { fibonacci(number) };
+    std::chrono::duration<double, std::milli> serial { std::chrono::steady_clock::now() - start };
+
+    std::cout << "serial:     " << serial.count() << " ms\n";
+
+    for (std::size_t threads { 1 }; threads <= std::max(1u, std::thread::hardware_concurrency()); threads *= 2)
+    {
+        Scheduler scheduler { threads };
+        std::uint64_t result { 0 };
+        FibonacciTask root { number, result };
+
+        start = std::chrono::steady_clock::now();
+        scheduler.run(root);
+        std::chrono::duration<double, std::milli> elapsed { std::chrono::steady_clock::now() - start };
+
+        std::cout << threads << " thread(s): " << elapsed.count() << " ms"
+                  << (result == expected ? "" : "  (wrong result)") << '\n';
+    }
+}
\ No newline at end of file
@@ -1,5 +1,20 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <typeinfo>
 #include <utility>
+#include <vector>
+#include <cxxabi.h>
 /**
  * Item 13 - Writing Exception-Safe Code - Part 6
 */
@@ -39,9 +54,24 @@ class Stack : private StackImpl<T>
 
         std::size_t count() const;
         void push(const T& element);
+        void push(T&& element);
         const T& top() const;
         T& top();
         void pop();
+
+    private:
+        template <class U>
+        void insert(U&& element);
+
+        template <class U>
+        void grow(U&& element);
+
+        template <class U>
+        void place(U&& element);
+
+        using StackImpl<T>::m_v;
+        using StackImpl<T>::m_size;
+        using StackImpl<T>::m_used;
 };
 
 // construct()
@@ -68,6 +98,142 @@ void destroy(ForwardIterator first, ForwardIterator last)
     }
 }
 
+/**
+ * Bulk helpers.
+ *
+ * destroyBulk() and copyBulk() are the ones from Item 12, together with the chunking helpers they rely on. Ranges of at
+ * least two bulkThreshold elements are split into one chunk per hardware thread and processed concurrently, anything
+ * smaller takes the plain serial loop, and trivially destructible or trivially copyable elements skip the work entirely.
+ * destroyBulk() is noexcept; copyBulk() gives the strong guarantee and cleans up after itself if a copy throws.
+ *
+ * StackImpl's destructor and Stack's copy constructor below use them.
+*/
+
+constexpr std::size_t bulkThreshold { std::size_t { 1 } << 16 };
+
+
+std::size_t bulkChunks(std::size_t count)
+{
+    if (count < 2 * bulkThreshold)
+    {
+        return 1;
+    }
+
+    return std::min<std::size_t>(std::max(1u, std::thread::hardware_concurrency()), count / bulkThreshold);
+}
+
+
+std::size_t chunkBegin(std::size_t count, std::size_t chunks, std::size_t chunk)
+{
+    return count / chunks * chunk + std::min(chunk, count % chunks);
+}
+
+
+// Calls function(chunk, begin, end) for every chunk of [ 0, count ), the first on the calling thread
+template <class Function>
+void forChunks(std::size_t count, std::size_t chunks, Function function) noexcept
+{
+    std::vector<std::thread> threads;
+    std::size_t chunk { 1 };
+
+    try
+    {
+        threads.reserve(chunks - 1);
+
+        for ( ; chunk < chunks; ++chunk)
+        {
+            threads.emplace_back(function, chunk, chunkBegin(count, chunks, chunk), chunkBegin(count, chunks, chunk + 1));
+        }
+    }
+    catch ( ... )
+    {
+        // Out of threads; whatever wasn't handed out runs here
+    }
+
+    function(0, 0, chunkBegin(count, chunks, 1));
+
+    for ( ; chunk < chunks; ++chunk)
+    {
+        function(chunk, chunkBegin(count, chunks, chunk), chunkBegin(count, chunks, chunk + 1));
+    }
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+
+template <class T>
+void destroyBulk(T* first, T* last) noexcept
+{
+    if constexpr (!std::is_trivially_destructible_v<T>)
+    {
+        std::size_t count ( last - first );
+        std::size_t chunks { bulkChunks(count) };
+
+        if (chunks == 1)
+        {
+            ::destroy(first, last);
+
+            return;
+        }
+
+        forChunks(count, chunks, [first](std::size_t, std::size_t begin, std::size_t end) noexcept
+        {
+            ::destroy(first + begin, first + end);
+        });
+    }
+}
+
+
+template <class T>
+void copyBulk(const T* first, const T* last, T* destination)
+{
+    std::size_t count ( last - first );
+    std::size_t chunks { std::is_trivially_copyable_v<T> ? 1 : bulkChunks(count) };
+
+    if (chunks == 1)
+    {
+        std::uninitialized_copy(first, last, destination);
+
+        return;
+    }
+
+    std::vector<std::exception_ptr> failures(chunks);
+
+    forChunks(count, chunks, [=, &failures](std::size_t chunk, std::size_t begin, std::size_t end) noexcept
+    {
+        try
+        {
+            std::uninitialized_copy(first + begin, first + end, destination + begin);
+        }
+        catch ( ... )
+        {
+            failures[chunk] = std::current_exception();
+        }
+    });
+
+    auto failure { std::find_if(failures.begin(), failures.end(), [](const std::exception_ptr& p) { return p; }) };
+
+    if (failure != failures.end())
+    {
+        for (std::size_t chunk { 0 }; chunk < chunks; ++chunk)
+        {
+            if (!failures[chunk])
+            {
+                std::size_t begin { chunkBegin(count, chunks, chunk) };
+                std::size_t end { chunkBegin(count, chunks, chunk + 1) };
+
+                ::destroy(destination + begin, destination + end);
+            }
+        }
+
+        std::rethrow_exception(*failure);
+    }
+}
+
+
 template <class T>
 void StackImpl<T>::swap(StackImpl& other) noexcept
 {
@@ -78,6 +244,211 @@ void StackImpl<T>::swap(StackImpl& other) noexcept
 
 /* -------------------------------------------------------------------------------------------------------------------- */
 
+/**
+ * Instrumentation.
+ *
+ * When a few Stacks dominate memory or latency, we want to know why: how often they grow, how long growing takes, how much
+ * they allocate, how deep they get, and how often copying or moving an element throws. Compile with
+ * -DSTACK_INSTRUMENTATION to record all of that per element type and print it at exit.
+ *
+ * The probes live in StackImpl's constructor and in Stack's push(), grow() and place() below. Without the macro every probe
+ * sits in a discarded "if constexpr" branch, so StackStats<T> is never even instantiated and Stack compiles to the same
+ * code as it would without them.
+*/
+
+#ifdef STACK_INSTRUMENTATION
+constexpr bool instrumented { true };
+#else
+constexpr bool instrumented { false };
+#endif
+
+class StackStatsBase
+{
+    public:
+        virtual void dump(std::ostream& os) const = 0;
+
+        static void dumpAll(std::ostream& os);
+
+    protected:
+        StackStatsBase();
+        ~StackStatsBase() = default;
+
+    private:
+        class Registry;
+        static Registry& registry();
+};
+
+template <class T>
+class StackStats : public StackStatsBase
+{
+    public:
+        static StackStats& instance();
+
+        void growth(std::chrono::nanoseconds elapsed);
+        void allocated(std::size_t bytes);
+        void used(std::size_t used);
+
+        void dump(std::ostream& os) const override;
+
+        std::atomic<std::uint64_t> m_growths { 0 };
+        std::atomic<std::uint64_t> m_growthNanoseconds { 0 };
+        std::atomic<std::uint64_t> m_slowestGrowthNanoseconds { 0 };
+        std::atomic<std::uint64_t> m_growthExceptions { 0 };
+        std::atomic<std::uint64_t> m_bytesAllocated { 0 };
+        std::atomic<std::uint64_t> m_highWater { 0 };
+        std::atomic<std::uint64_t> m_copies { 0 };
+        std::atomic<std::uint64_t> m_copyExceptions { 0 };
+        std::atomic<std::uint64_t> m_moves { 0 };
+        std::atomic<std::uint64_t> m_moveExceptions { 0 };
+
+    private:
+        StackStats() = default;
+};
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Aggregation and reporting.
+ *
+ * Every StackStats<T> registers itself on first use. The registry prints them all when it is destroyed at exit.
+ *
+ * The StackStats objects themselves are deliberately never destroyed. They're created after the registry, so as ordinary
+ * function-local statics they would be destroyed before it, and the registry would be left printing dead objects.
+*/
+
+class StackStatsBase::Registry
+{
+    public:
+        ~Registry()
+        {
+            dump(std::cerr);
+        }
+
+        void dump(std::ostream& os)
+        {
+            std::lock_guard<std::mutex> lock { m_mutex };
+
+            for (const StackStatsBase* stats : m_stats)
+            {
+                stats->dump(os);
+            }
+        }
+
+        std::mutex m_mutex;
+        std::vector<const StackStatsBase*> m_stats;
+};
+
+
+StackStatsBase::StackStatsBase()
+{
+    Registry& all { registry() };
+    std::lock_guard<std::mutex> lock { all.m_mutex };
+
+    all.m_stats.push_back(this);
+}
+
+
+StackStatsBase::Registry& StackStatsBase::registry()
+{
+    static Registry all;
+
+    return all;
+}
+
+
+void StackStatsBase::dumpAll(std::ostream& os)
+{
+    registry().dump(os);
+}
+
+
+template <class T>
+StackStats<T>& StackStats<T>::instance()
+{
+    static StackStats* p_stats { new StackStats };
+
+    return *p_stats;
+}
+
+
+template <class T>
+void StackStats<T>::growth(std::chrono::nanoseconds elapsed)
+{
+    std::uint64_t nanoseconds { static_cast<std::uint64_t>(elapsed.count()) };
+    std::uint64_t slowest { m_slowestGrowthNanoseconds.load(std::memory_order_relaxed) };
+
+    m_growths.fetch_add(1, std::memory_order_relaxed);
+    m_growthNanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+
+    while (slowest < nanoseconds &&
+           !m_slowestGrowthNanoseconds.compare_exchange_weak(slowest, nanoseconds, std::memory_order_relaxed)) { }
+}
+
+
+template <class T>
+void StackStats<T>::allocated(std::size_t bytes)
+{
+    m_bytesAllocated.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+
+template <class T>
+void StackStats<T>::used(std::size_t used)
+{
+    std::uint64_t highWater { m_highWater.load(std::memory_order_relaxed) };
+
+    while (highWater < used && !m_highWater.compare_exchange_weak(highWater, used, std::memory_order_relaxed)) { }
+}
+
+
+/**
+ * typeid(T).name() is the mangled name, so dump() demangles it first. If that fails we fall back to the mangled name.
+*/
+
+template <class T>
+void StackStats<T>::dump(std::ostream& os) const
+{
+    int status { 0 };
+    std::unique_ptr<char, void (*)(void*)> p_name { abi::__cxa_demangle(typeid(T).name(), nullptr, nullptr, &status),
+                                                    std::free };
+
+    os << "Stack<" << (status == 0 ? p_name.get() : typeid(T).name()) << ">:\n"
+       << "    growths:         " << m_growths << " (" << m_growthNanoseconds << " ns total, "
+                                   << m_slowestGrowthNanoseconds << " ns slowest, " << m_growthExceptions << " threw)\n"
+       << "    bytes allocated: " << m_bytesAllocated << '\n'
+       << "    high-water mark: " << m_highWater << " elements\n"
+       << "    copies:          " << m_copies << " (" << m_copyExceptions << " threw)\n"
+       << "    moves:           " << m_moves << " (" << m_moveExceptions << " threw)\n";
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * StackImpl's constructor and destructor.
+ *
+ * These are the same as in Item 12, plus the probe that records how much raw memory each Stack allocates.
+*/
+
+template <class T>
+StackImpl<T>::StackImpl(std::size_t size)
+    : m_v { static_cast<T*>(size == 0 ? nullptr : operator new(sizeof(T) * size)) }, m_size { size }, m_used { 0 }
+{
+    if constexpr (instrumented)
+    {
+        StackStats<T>::instance().allocated(sizeof(T) * size);
+    }
+}
+
+
+template <class T>
+StackImpl<T>::~StackImpl()
+{
+    destroyBulk(m_v, m_v + m_used);
+    operator delete(m_v);
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
 /**
  * Default constructor.
  *
@@ -106,19 +477,37 @@ Stack<T>::Stack(std::size_t size)
  *
  * Stack copy constructor does not call the StackImpl copy constructor.
  *
- * The worst that can happen here is that a T constructor could fail, in which case the StackImpl destructor will correctly
- * destroy exactly as many objects as were successfully created and then deallocate the raw memory.
+ * The worst that can happen here is that a T constructor could fail. copyBulk() then destroys the elements it had already
+ * copied, m_used is still 0, and the StackImpl destructor just deallocates the raw memory.
 */
 
 template <class T>
 Stack<T>::Stack(const Stack& other)
     : StackImpl<T> { other.m_used }
 {
-    while (m_used < other.m_used)
+    if constexpr (instrumented)
     {
-        construct(m_v + m_used, other.m_v[m_used]);
-        ++m_used;
+        StackStats<T>& stats { StackStats<T>::instance() };
+
+        try
+        {
+            copyBulk(other.m_v, other.m_v + other.m_used, m_v);
+        }
+        catch ( ... )
+        {
+            ++stats.m_copyExceptions;
+            throw;
+        }
+
+        stats.m_copies += other.m_used;
+        stats.used(other.m_used);
+    }
+    else
+    {
+        copyBulk(other.m_v, other.m_v + other.m_used, m_v);
     }
+
+    m_used = other.m_used;
 }
 
 /* -------------------------------------------------------------------------------------------------------------------- */
@@ -133,7 +522,7 @@ template <class T>
 Stack<T>& Stack<T>::operator = (const Stack& other)
 {
     Stack temp { other };
-    swap(temp);
+    this->swap(temp);
 
     return *this;
 }
@@ -157,37 +546,62 @@ std::size_t Stack<T>::count() const
 /**
  * push().
  *
- * push() needs a little more attention.
+ * push() needs a little more attention. There is a push(T&&) as well, so that rvalues are moved rather than copied, and
+ * both overloads share their work through insert().
 */
 
 template <class T>
 void Stack<T>::push(const T& element)
+{
+    insert(element);
+}
+
+
+template <class T>
+void Stack<T>::push(T&& element)
+{
+    insert(std::move(element));
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * insert() and grow().
+ *
+ * When instrumented, insert() wraps grow() with a timer, so each growth event records how long it took, including the
+ * allocation and every element copy, and whether it ended in an exception.
+*/
+
+template <class T>
+template <class U>
+void Stack<T>::insert(U&& element)
 {
     /**
      * If we don't have enough room for the new element, we trigger a reallocation.
     */
     if (m_used == m_size)
     {
-        /**
-         * We simply construct a temporary Stack object, push the new element onto that, and finally swap out our original
-         * guts to it to ensure they're disposed of in a tidy fashion.
-         *
-         * If the construction of temp fails, our state is unchanged and no resources have been leaked, so that's fine.
-         *
-         * If any part of the loading of temp's contents (including the new object's copy construction) fails by throwing an
-         * exception, temp is properly cleaned up when its destructor is called as temp goes out of scope.
-         *
-         * In no case do we alter our state until all the work has already been completed successfully.
-        */
-        Stack temp { m_size * 2 + 1 };
+        if constexpr (instrumented)
+        {
+            StackStats<T>& stats { StackStats<T>::instance() };
+            auto start { std::chrono::steady_clock::now() };
 
-        while (temp.count() < m_used)
+            try
+            {
+                grow(std::forward<U>(element));
+            }
+            catch ( ... )
+            {
+                ++stats.m_growthExceptions;
+                throw;
+            }
+
+            stats.growth(std::chrono::steady_clock::now() - start);
+        }
+        else
         {
-            temp.push(m_v[ temp.count() ]);
+            grow(std::forward<U>(element));
         }
-
-        temp.push(element);
-        swap(temp);
     }
     else
     {
@@ -195,7 +609,73 @@ void Stack<T>::push(const T& element)
          * If we already have room for the new object, we attempt to construct it. If the construction succeeds, we update
          * our m_used count.
         */
-        construct(m_v + m_used, element);
+        place(std::forward<U>(element));
+    }
+}
+
+
+template <class T>
+template <class U>
+void Stack<T>::grow(U&& element)
+{
+    /**
+     * We simply construct a temporary Stack object, push the new element onto that, and finally swap out our original
+     * guts to it to ensure they're disposed of in a tidy fashion.
+     *
+     * If the construction of temp fails, our state is unchanged and no resources have been leaked, so that's fine.
+     *
+     * If any part of the loading of temp's contents (including the new object's copy construction) fails by throwing an
+     * exception, temp is properly cleaned up when its destructor is called as temp goes out of scope.
+     *
+     * In no case do we alter our state until all the work has already been completed successfully.
+    */
+    Stack temp { m_size * 2 + 1 };
+
+    while (temp.count() < m_used)
+    {
+        temp.place(m_v[ temp.count() ]);
+    }
+
+    temp.place(std::forward<U>(element));
+    this->swap(temp);
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * place().
+ *
+ * Constructs the next element and updates m_used. Whether it copies or moves is decided by the value category of the
+ * argument, so when instrumented, one probe counts both paths and the high-water mark. A failed construction is counted
+ * and rethrown untouched; we remain exception-neutral.
+*/
+
+template <class T>
+template <class U>
+void Stack<T>::place(U&& element)
+{
+    if constexpr (instrumented)
+    {
+        constexpr bool moving { !std::is_lvalue_reference_v<U> };
+        StackStats<T>& stats { StackStats<T>::instance() };
+
+        try
+        {
+            new (m_v + m_used) T(std::forward<U>(element));
+        }
+        catch ( ... )
+        {
+            ++(moving ? stats.m_moveExceptions : stats.m_copyExceptions);
+            throw;
+        }
+
+        ++(moving ? stats.m_moves : stats.m_copies);
+        ++m_used;
+        stats.used(m_used);
+    }
+    else
+    {
+        new (m_v + m_used) T(std::forward<U>(element));
         ++m_used;
     }
 }
@@ -235,5 +715,415 @@ void Stack<T>::pop()
     else
     {
         --m_used;
+        ::destroy(m_v + m_used);
+    }
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Small-buffer optimization.
+ *
+ * Most stacks never hold more than a handful of elements, yet StackImpl goes to the free store on the very first push. We
+ * can give StackImpl raw inline storage for the first N elements and only spill to the heap when that is exceeded. The
+ * buffer is still raw memory, so the rule from Item 12 stays the same: the m_v buffer contains exactly m_used constructed
+ * T objects, no more, no less.
+ *
+ * SmallStackImpl and SmallStack are StackImpl and Stack with the inline buffer added. They get names of their own because
+ * a class template can't be redeclared with a different number of parameters.
+*/
+
+template <class T, std::size_t N = 8>
+class SmallStackImpl
+{
+    static_assert(N > 0, "Use the heap-only StackImpl for N == 0");
+
+    protected:
+        SmallStackImpl(std::size_t size = 0);
+        ~SmallStackImpl();
+
+        // No copying allowed
+        SmallStackImpl(const SmallStackImpl& other) = delete;
+        SmallStackImpl& operator = (const SmallStackImpl& other) = delete;
+
+        static constexpr bool nothrowSwap { std::is_nothrow_move_constructible_v<T> && std::is_nothrow_swappable_v<T> };
+
+        void swap(SmallStackImpl& other) noexcept(nothrowSwap);
+        void take(SmallStackImpl& other) noexcept;
+
+        static void build(T* target, T* source, std::size_t count);
+
+        T* inlineBuffer() noexcept;
+        bool isInline() const noexcept;
+
+        alignas(T) unsigned char m_buffer[sizeof(T) * N];
+        T* m_v;
+        std::size_t m_size;
+        std::size_t m_used;
+};
+
+template <class T, std::size_t N = 8>
+class SmallStack : private SmallStackImpl<T, N>
+{
+    public:
+        SmallStack(std::size_t size = 0);
+        ~SmallStack() = default;
+
+        SmallStack(const SmallStack& other);
+        SmallStack& operator = (const SmallStack& other);
+
+        void swap(SmallStack& other) noexcept(SmallStackImpl<T, N>::nothrowSwap);
+
+        std::size_t count() const;
+        void push(const T& element);
+        const T& top() const;
+        T& top();
+        void pop();
+
+    private:
+        SmallStack(const SmallStack& other, std::size_t size);
+
+        using SmallStackImpl<T, N>::m_v;
+        using SmallStackImpl<T, N>::m_size;
+        using SmallStackImpl<T, N>::m_used;
+};
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * SmallStackImpl constructor and destructor.
+ *
+ * Requests that fit in the inline buffer never touch operator new(). Larger requests allocate raw memory exactly as
+ * before. The destructor has to remember which of the two it owns.
+*/
+
+template <class T, std::size_t N>
+SmallStackImpl<T, N>::SmallStackImpl(std::size_t size)
+    : m_v { size <= N ? inlineBuffer() : static_cast<T*>(operator new(sizeof(T) * size)) },
+      m_size { size <= N ? N : size },
+      m_used { 0 } { }
+
+
+template <class T, std::size_t N>
+SmallStackImpl<T, N>::~SmallStackImpl()
+{
+    ::destroy(m_v, m_v + m_used);
+
+    if (!isInline())
+    {
+        operator delete(m_v);
+    }
+}
+
+
+template <class T, std::size_t N>
+T* SmallStackImpl<T, N>::inlineBuffer() noexcept
+{
+    return std::launder(reinterpret_cast<T*>(m_buffer));
+}
+
+
+template <class T, std::size_t N>
+bool SmallStackImpl<T, N>::isInline() const noexcept
+{
+    return m_v == reinterpret_cast<const T*>(m_buffer);
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * swap().
+ *
+ * This is where the inline buffer bites. Two heap buffers can still be exchanged by pointer, but an inline buffer lives
+ * inside the object itself, so its elements have to be transferred one by one, and swap() keeps the strong guarantee the
+ * same way operator = () does: everything that can throw happens on the side, and the commit can't fail.
+ *
+ * - One inline, one heap: the inline elements are built in the other object's unused inline buffer with
+ *   std::move_if_noexcept(), i.e. copied if moving might throw. If that fails, the copies are destroyed and both objects
+ *   are untouched. Otherwise the originals are destroyed and the heap pointer changes hands.
+ * - Both inline: if T can be moved and swapped without throwing, the elements are simply swapped in place. If not, there
+ *   is no spare room to build either side without tearing down the other, so both sides are copied to the heap, and the
+ *   commit is two take()s, which are pointer handovers.
+ *
+ * swap() is noexcept exactly when none of this can throw. A T that can only be moved, with a move that may throw, can't
+ * be transferred without risk, and gets the basic guarantee.
+*/
+
+template <class T, std::size_t N>
+void SmallStackImpl<T, N>::swap(SmallStackImpl& other) noexcept(nothrowSwap)
+{
+    if (!isInline() && !other.isInline())
+    {
+        std::swap(m_v, other.m_v);
+        std::swap(m_size, other.m_size);
+        std::swap(m_used, other.m_used);
+
+        return;
+    }
+
+    if (isInline() && other.isInline())
+    {
+        if constexpr (nothrowSwap)
+        {
+            SmallStackImpl& longer { m_used >= other.m_used ? *this : other };
+            SmallStackImpl& shorter { m_used >= other.m_used ? other : *this };
+            std::size_t common { shorter.m_used };
+
+            for (std::size_t i { 0 }; i < common; ++i)
+            {
+                std::swap(m_v[i], other.m_v[i]);
+            }
+
+            while (shorter.m_used < longer.m_used)
+            {
+                new (shorter.m_v + shorter.m_used) T(std::move(longer.m_v[shorter.m_used]));
+                ++shorter.m_used;
+            }
+
+            ::destroy(longer.m_v + common, longer.m_v + longer.m_used);
+            longer.m_used = common;
+        }
+        else
+        {
+            SmallStackImpl mine { N + 1 };
+            SmallStackImpl theirs { N + 1 };
+
+            build(mine.m_v, m_v, m_used);
+            mine.m_used = m_used;
+            build(theirs.m_v, other.m_v, other.m_used);
+            theirs.m_used = other.m_used;
+
+            take(theirs);
+            other.take(mine);
+        }
+
+        return;
+    }
+
+    SmallStackImpl& inlined { isInline() ? *this : other };
+    SmallStackImpl& heaped { isInline() ? other : *this };
+
+    T* target { heaped.inlineBuffer() };
+    std::size_t moved { inlined.m_used };
+
+    build(target, inlined.m_v, moved);
+    ::destroy(inlined.m_v, inlined.m_v + moved);
+
+    inlined.m_v = heaped.m_v;
+    inlined.m_size = heaped.m_size;
+    inlined.m_used = heaped.m_used;
+
+    heaped.m_v = target;
+    heaped.m_size = N;
+    heaped.m_used = moved;
+}
+
+
+// Builds count elements at target from source, copying them if moving could throw; on failure, unbuilds them again
+template <class T, std::size_t N>
+void SmallStackImpl<T, N>::build(T* target, T* source, std::size_t count)
+{
+    std::size_t built { 0 };
+
+    try
+    {
+        for ( ; built < count; ++built)
+        {
+            new (target + built) T(std::move_if_noexcept(source[built]));
+        }
+    }
+    catch ( ... )
+    {
+        ::destroy(target, target + built);
+        throw;
+    }
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * take().
+ *
+ * Copy-and-swap never needs the old contents of *this afterwards; it only swaps so that temp's destructor will clean them
+ * up. take() does that cleanup directly and then steals other's contents, leaving other empty.
+ *
+ * If other's buffer is on the heap this is nothing but pointer assignments. If other is inline, its elements have to be
+ * moved, so callers may only take() an inline SmallStackImpl when T's move constructor cannot throw.
+*/
+
+template <class T, std::size_t N>
+void SmallStackImpl<T, N>::take(SmallStackImpl& other) noexcept
+{
+    ::destroy(m_v, m_v + m_used);
+
+    if (!isInline())
+    {
+        operator delete(m_v);
+    }
+
+    m_v = inlineBuffer();
+    m_size = N;
+    m_used = 0;
+
+    if (!other.isInline())
+    {
+        m_v = other.m_v;
+        m_size = other.m_size;
+        m_used = other.m_used;
+
+        other.m_v = other.inlineBuffer();
+        other.m_size = N;
+        other.m_used = 0;
+    }
+    else
+    {
+        while (m_used < other.m_used)
+        {
+            new (m_v + m_used) T(std::move(other.m_v[m_used]));
+            ++m_used;
+        }
+
+        ::destroy(other.m_v, other.m_v + other.m_used);
+        other.m_used = 0;
+    }
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Constructors.
+ *
+ * Nothing changes here except that small stacks end up inline. The private constructor lets the caller ask for more room
+ * than other needs, which is how operator = () forces its temporary onto the heap.
+*/
+
+template <class T, std::size_t N>
+SmallStack<T, N>::SmallStack(std::size_t size)
+    : SmallStackImpl<T, N> { size } { }
+
+
+template <class T, std::size_t N>
+SmallStack<T, N>::SmallStack(const SmallStack& other)
+    : SmallStack { other, other.m_used } { }
+
+
+template <class T, std::size_t N>
+SmallStack<T, N>::SmallStack(const SmallStack& other, std::size_t size)
+    : SmallStackImpl<T, N> { size }
+{
+    while (m_used < other.m_used)
+    {
+        construct(m_v + m_used, other.m_v[m_used]);
+        ++m_used;
+    }
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Copy assignment.
+ *
+ * Still copy-and-swap, and still the strong guarantee: all the work that can throw happens while building temp, and the
+ * commit must not throw.
+ *
+ * If T can be moved without throwing, the commit may move an inline temp across, so temp is as small as it likes. If T's
+ * move constructor might throw, we give up the inline buffer for the temporary and build it on the heap instead. The
+ * commit is then a pointer handover, which cannot fail. That costs one allocation, but only for the types that would
+ * otherwise lose the guarantee.
+*/
+
+template <class T, std::size_t N>
+SmallStack<T, N>& SmallStack<T, N>::operator = (const SmallStack& other)
+{
+    if constexpr (std::is_nothrow_move_constructible_v<T>)
+    {
+        SmallStack temp { other };
+        this->take(temp);
+    }
+    else
+    {
+        SmallStack temp { other, std::max(other.m_used, N + 1) };
+        this->take(temp);
+    }
+
+    return *this;
+}
+
+
+template <class T, std::size_t N>
+void SmallStack<T, N>::swap(SmallStack& other) noexcept(SmallStackImpl<T, N>::nothrowSwap)
+{
+    SmallStackImpl<T, N>::swap(other);
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * push().
+ *
+ * The growth path always produces a buffer larger than N, so temp lives on the heap and take() is a pointer handover. Our
+ * old elements, inline or not, are destroyed only after everything that could throw has already succeeded.
+*/
+
+template <class T, std::size_t N>
+std::size_t SmallStack<T, N>::count() const
+{
+    return m_used;
+}
+
+
+template <class T, std::size_t N>
+void SmallStack<T, N>::push(const T& element)
+{
+    if (m_used == m_size)
+    {
+        SmallStack temp { m_size * 2 + 1 };
+
+        while (temp.count() < m_used)
+        {
+            temp.push(m_v[ temp.count() ]);
+        }
+
+        temp.push(element);
+        this->take(temp);
+    }
+    else
+    {
+        construct(m_v + m_used, element);
+        ++m_used;
+    }
+}
+
+
+template <class T, std::size_t N>
+const T& SmallStack<T, N>::top() const
+{
+    if (m_used == 0)
+    {
+        throw("Empty Stack");
+    }
+
+    return m_v[m_used - 1];
+}
+
+
+template <class T, std::size_t N>
+T& SmallStack<T, N>::top()
+{
+    return const_cast<T&>(std::as_const(*this).top());
+}
+
+
+template <class T, std::size_t N>
+void SmallStack<T, N>::pop()
+{
+    if (m_used == 0)
+    {
+        throw("Popping from empty stack.");
+    }
+    else
+    {
+        --m_used;
+        ::destroy(m_v + m_used);
     }
 }
\ No newline at end of file
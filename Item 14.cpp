@@ -1,5 +1,30 @@
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
 #include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <type_traits>
 #include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
 /**
  * Item 14 - Writing Exception-Safe Code - Part 7
 */
@@ -44,6 +69,9 @@ class Stack
         T& top();
         void pop();
 
+        void save(const std::string& path) const;
+        void load(const std::string& path);
+
     private:
         StackImpl<T> m_impl;
 };
@@ -72,6 +100,153 @@ void destroy(ForwardIterator first, ForwardIterator last)
     }
 }
 
+/**
+ * Bulk helpers.
+ *
+ * StackImpl's destructor and Stack's copy constructor below hand whole ranges to destroyBulk() and copyBulk() from Item 12,
+ * copied here with the chunking helpers they rely on. Large ranges are split across the hardware threads, small ones run
+ * the serial loop, and trivial element types skip it altogether. destroyBulk() is noexcept, and copyBulk() either copies
+ * the whole range or destroys what it had copied and rethrows.
+*/
+
+constexpr std::size_t bulkThreshold { std::size_t { 1 } << 16 };
+
+
+std::size_t bulkChunks(std::size_t count)
+{
+    if (count < 2 * bulkThreshold)
+    {
+        return 1;
+    }
+
+    return std::min<std::size_t>(std::max(1u, std::thread::hardware_concurrency()), count / bulkThreshold);
+}
+
+
+std::size_t chunkBegin(std::size_t count, std::size_t chunks, std::size_t chunk)
+{
+    return count / chunks * chunk + std::min(chunk, count % chunks);
+}
+
+
+// Calls function(chunk, begin, end) for every chunk of [ 0, count ), the first on the calling thread
+template <class Function>
+void forChunks(std::size_t count, std::size_t chunks, Function function) noexcept
+{
+    std::vector<std::thread> threads;
+    std::size_t chunk { 1 };
+
+    try
+    {
+        threads.reserve(chunks - 1);
+
+        for ( ; chunk < chunks; ++chunk)
+        {
+            threads.emplace_back(function, chunk, chunkBegin(count, chunks, chunk), chunkBegin(count, chunks, chunk + 1));
+        }
+    }
+    catch ( ... )
+    {
+        // Out of threads; whatever wasn't handed out runs here
+    }
+
+    function(0, 0, chunkBegin(count, chunks, 1));
+
+    for ( ; chunk < chunks; ++chunk)
+    {
+        function(chunk, chunkBegin(count, chunks, chunk), chunkBegin(count, chunks, chunk + 1));
+    }
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+
+template <class T>
+void destroyBulk(T* first, T* last) noexcept
+{
+    if constexpr (!std::is_trivially_destructible_v<T>)
+    {
+        std::size_t count ( last - first );
+        std::size_t chunks { bulkChunks(count) };
+
+        if (chunks == 1)
+        {
+            ::destroy(first, last);
+
+            return;
+        }
+
+        forChunks(count, chunks, [first](std::size_t, std::size_t begin, std::size_t end) noexcept
+        {
+            ::destroy(first + begin, first + end);
+        });
+    }
+}
+
+
+template <class T>
+void copyBulk(const T* first, const T* last, T* destination)
+{
+    std::size_t count ( last - first );
+    std::size_t chunks { std::is_trivially_copyable_v<T> ? 1 : bulkChunks(count) };
+
+    if (chunks == 1)
+    {
+        std::uninitialized_copy(first, last, destination);
+
+        return;
+    }
+
+    std::vector<std::exception_ptr> failures(chunks);
+
+    forChunks(count, chunks, [=, &failures](std::size_t chunk, std::size_t begin, std::size_t end) noexcept
+    {
+        try
+        {
+            std::uninitialized_copy(first + begin, first + end, destination + begin);
+        }
+        catch ( ... )
+        {
+            failures[chunk] = std::current_exception();
+        }
+    });
+
+    auto failure { std::find_if(failures.begin(), failures.end(), [](const std::exception_ptr& p) { return p; }) };
+
+    if (failure != failures.end())
+    {
+        for (std::size_t chunk { 0 }; chunk < chunks; ++chunk)
+        {
+            if (!failures[chunk])
+            {
+                std::size_t begin { chunkBegin(count, chunks, chunk) };
+                std::size_t end { chunkBegin(count, chunks, chunk + 1) };
+
+                ::destroy(destination + begin, destination + end);
+            }
+        }
+
+        std::rethrow_exception(*failure);
+    }
+}
+
+
+template <class T>
+StackImpl<T>::StackImpl(std::size_t size)
+    : m_v { static_cast<T*>(size == 0 ? nullptr : operator new(sizeof(T) * size)) }, m_size { size }, m_used { 0 } { }
+
+
+template <class T>
+StackImpl<T>::~StackImpl()
+{
+    destroyBulk(m_v, m_v + m_used);
+    operator delete(m_v);
+}
+
+
 template <class T>
 void StackImpl<T>::swap(StackImpl& other) noexcept
 {
@@ -91,11 +266,8 @@ template <class T>
 Stack<T>::Stack(const Stack& other)
     : m_impl { other.m_impl.m_used }
 {
-    while (m_impl.m_used < other.m_impl.m_used)
-    {
-        construct(m_impl.m_v + m_impl.m_used, other.m_impl.m_v[m_impl.m_used]);
-        ++m_impl.m_used;
-    }
+    copyBulk(other.m_impl.m_v, other.m_impl.m_v + other.m_impl.m_used, m_impl.m_v);
+    m_impl.m_used = other.m_impl.m_used;
 }
 
 
@@ -163,4 +335,1690 @@ void Stack<T>::pop()
         --m_impl.m_used;
         destroy(m_impl.m_v + m_impl.m_used);
     }
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Bounded ring-buffer queues.
+ *
+ * A mutex-guarded Stack makes a poor queue between threads: every push and pop takes the same lock, and the items come out
+ * in the wrong order. A bounded ring buffer does the job without any lock at all.
+ *
+ * The storage follows StackImpl's model. RingImpl owns raw memory only, and a slot holds a constructed T exactly while it
+ * is occupied: push() constructs into it, pop() destroys it. Every slot is padded out to its own cache line, and so are the
+ * producer and consumer indices, so threads working on neighbouring slots don't keep stealing each other's cache lines.
+*/
+
+constexpr std::size_t cacheLine { 64 };
+
+template <class T>
+struct alignas(cacheLine) RingSlot
+{
+    T* element() noexcept
+    {
+        return std::launder(reinterpret_cast<T*>(m_storage));
+    }
+
+    std::atomic<std::size_t> m_sequence;                    // Only used by the multi-producer queue
+    alignas(T) unsigned char m_storage[sizeof(T)];
+};
+
+template <class T>
+class RingImpl
+{
+    public:
+        RingImpl(std::size_t size);
+        ~RingImpl();
+
+        // No copying allowed
+        RingImpl(const RingImpl& other) = delete;
+        RingImpl& operator = (const RingImpl& other) = delete;
+
+        RingSlot<T>& slot(std::size_t index) noexcept;
+
+        RingSlot<T>* m_v;
+        std::size_t m_size;                                 // Always a power of two
+};
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * RingImpl.
+ *
+ * Like StackImpl, RingImpl never constructs or destroys a T. Its destructor only frees memory; the queue that owns it knows
+ * which slots are occupied and destroys those first.
+ *
+ * Positions are mapped to slots with a mask, so the size asked for is rounded up to a power of two. It's at least two, or
+ * the multi-producer queue couldn't tell a slot that was just filled from one that was just emptied.
+*/
+
+template <class T>
+RingImpl<T>::RingImpl(std::size_t size)
+    : m_v { static_cast<RingSlot<T>*>(operator new(sizeof(RingSlot<T>) * std::bit_ceil(std::max<std::size_t>(size, 2)),
+                                                    std::align_val_t { alignof(RingSlot<T>) })) },
+      m_size { std::bit_ceil(std::max<std::size_t>(size, 2)) }
+{
+    // Slot i is ready for the producer that claims position i
+    for (std::size_t i { 0 }; i < m_size; ++i)
+    {
+        new (m_v + i) RingSlot<T>;
+        m_v[i].m_sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+
+template <class T>
+RingImpl<T>::~RingImpl()
+{
+    operator delete(m_v, std::align_val_t { alignof(RingSlot<T>) });
+}
+
+
+template <class T>
+RingSlot<T>& RingImpl<T>::slot(std::size_t index) noexcept
+{
+    return m_v[index & (m_size - 1)];
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Single-producer / single-consumer queue.
+ *
+ * With one thread on each end, each index has exactly one writer, so plain loads and stores with acquire/release ordering
+ * are enough. Each side also keeps a private copy of the other side's index and only rereads the shared one when the copy
+ * says the queue is full (or empty).
+ *
+ * pop() follows the lesson of Item 10: it doesn't return the element by value. It assigns it to the caller's object first,
+ * and only if that succeeds does it destroy the slot and publish the new head. The element is moved only if T's move
+ * assignment can't throw, and copied otherwise, so if the assignment throws, the element is still in the queue, intact.
+ * push() is just as strong: if T's constructor throws, the new tail is never published.
+*/
+
+template <class T>
+class SpscQueue
+{
+    public:
+        SpscQueue(std::size_t size);
+        ~SpscQueue();
+
+        bool tryPush(const T& element);
+        bool tryPop(T& element);
+
+    private:
+        RingImpl<T> m_impl;
+
+        alignas(cacheLine) std::atomic<std::size_t> m_tail;
+        std::size_t m_cachedHead;                           // Producer's view of m_head
+
+        alignas(cacheLine) std::atomic<std::size_t> m_head;
+        std::size_t m_cachedTail;                           // Consumer's view of m_tail
+};
+
+
+template <class T>
+SpscQueue<T>::SpscQueue(std::size_t size)
+    : m_impl { size }, m_tail { 0 }, m_cachedHead { 0 }, m_head { 0 }, m_cachedTail { 0 } { }
+
+
+template <class T>
+SpscQueue<T>::~SpscQueue()
+{
+    for (std::size_t i { m_head.load() }, end { m_tail.load() }; i != end; ++i)
+    {
+        destroy(m_impl.slot(i).element());
+    }
+}
+
+
+template <class T>
+bool SpscQueue<T>::tryPush(const T& element)
+{
+    std::size_t tail { m_tail.load(std::memory_order_relaxed) };
+
+    if (tail - m_cachedHead == m_impl.m_size)
+    {
+        m_cachedHead = m_head.load(std::memory_order_acquire);
+
+        if (tail - m_cachedHead == m_impl.m_size)
+        {
+            return false;
+        }
+    }
+
+    construct(m_impl.slot(tail).element(), element);
+    m_tail.store(tail + 1, std::memory_order_release);
+
+    return true;
+}
+
+
+template <class T>
+bool SpscQueue<T>::tryPop(T& element)
+{
+    std::size_t head { m_head.load(std::memory_order_relaxed) };
+
+    if (head == m_cachedTail)
+    {
+        m_cachedTail = m_tail.load(std::memory_order_acquire);
+
+        if (head == m_cachedTail)
+        {
+            return false;
+        }
+    }
+
+    T* occupied { m_impl.slot(head).element() };
+
+    if constexpr (std::is_nothrow_move_assignable_v<T>)
+    {
+        element = std::move(*occupied);
+    }
+    else
+    {
+        element = *occupied;
+    }
+
+    destroy(occupied);
+    m_head.store(head + 1, std::memory_order_release);
+
+    return true;
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Multi-producer / multi-consumer queue.
+ *
+ * This is Dmitry Vyukov's bounded queue. Producers and consumers each race for positions with a compare-exchange, and a
+ * per-slot sequence number says whose turn it is: a slot whose sequence equals the position is free for the producer of
+ * that position, and one whose sequence is position + 1 holds an element for the consumer of that position.
+ *
+ * Here we can't offer the rollback the SPSC queue does. Once a producer has claimed a position, the consumer of that
+ * position will wait for it, so there's no way to give it back. We therefore do everything that can throw before claiming:
+ * tryPush() copies the element first, and the claimed slot is filled by a move that is required not to throw. tryPop()
+ * likewise only moves out of the slot.
+*/
+
+template <class T>
+class MpmcQueue
+{
+    static_assert(std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>,
+                  "A claimed slot can't be given back, so filling or emptying it must not throw");
+
+    public:
+        MpmcQueue(std::size_t size);
+        ~MpmcQueue();
+
+        bool tryPush(const T& element);
+        bool tryPop(T& element);
+
+    private:
+        RingImpl<T> m_impl;
+
+        alignas(cacheLine) std::atomic<std::size_t> m_tail;
+        alignas(cacheLine) std::atomic<std::size_t> m_head;
+};
+
+
+template <class T>
+MpmcQueue<T>::MpmcQueue(std::size_t size)
+    : m_impl { size }, m_tail { 0 }, m_head { 0 } { }
+
+
+template <class T>
+MpmcQueue<T>::~MpmcQueue()
+{
+    for (std::size_t i { m_head.load() }, end { m_tail.load() }; i != end; ++i)
+    {
+        destroy(m_impl.slot(i).element());
+    }
+}
+
+
+template <class T>
+bool MpmcQueue<T>::tryPush(const T& element)
+{
+    T copy { element };
+    std::size_t position { m_tail.load(std::memory_order_relaxed) };
+
+    while (true)
+    {
+        RingSlot<T>& slot { m_impl.slot(position) };
+        std::size_t sequence { slot.m_sequence.load(std::memory_order_acquire) };
+        std::ptrdiff_t difference { static_cast<std::ptrdiff_t>(sequence - position) };
+
+        if (difference == 0)
+        {
+            if (m_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                new (slot.element()) T(std::move(copy));
+                slot.m_sequence.store(position + 1, std::memory_order_release);
+
+                return true;
+            }
+        }
+        else if (difference < 0)
+        {
+            // The consumer of the previous lap hasn't emptied this slot yet
+            return false;
+        }
+        else
+        {
+            position = m_tail.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+
+template <class T>
+bool MpmcQueue<T>::tryPop(T& element)
+{
+    std::size_t position { m_head.load(std::memory_order_relaxed) };
+
+    while (true)
+    {
+        RingSlot<T>& slot { m_impl.slot(position) };
+        std::size_t sequence { slot.m_sequence.load(std::memory_order_acquire) };
+        std::ptrdiff_t difference { static_cast<std::ptrdiff_t>(sequence - (position + 1)) };
+
+        if (difference == 0)
+        {
+            if (m_head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                element = std::move(*slot.element());
+                destroy(slot.element());
+                slot.m_sequence.store(position + m_impl.m_size, std::memory_order_release);
+
+                return true;
+            }
+        }
+        else if (difference < 0)
+        {
+            // Nothing has been pushed at this position yet
+            return false;
+        }
+        else
+        {
+            position = m_head.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Benchmarks.
+ *
+ * The baseline is what the pipelines do today: a Stack behind a std::mutex. It's not even a queue (items come out LIFO),
+ * but it moves the same number of items between the same threads, so the comparison is fair for throughput.
+ *
+ * Throughput: producers push a fixed number of items, consumers pop until they've seen all of them.
+ * Latency: two threads bounce a single item back and forth through a pair of queues; half the average round trip is the
+ * one-way hand-off latency.
+*/
+
+template <class T>
+class LockedStack
+{
+    public:
+        bool tryPush(const T& element)
+        {
+            std::lock_guard<std::mutex> lock { m_mutex };
+            m_stack.push(element);
+
+            return true;
+        }
+
+        bool tryPop(T& element)
+        {
+            std::lock_guard<std::mutex> lock { m_mutex };
+
+            if (m_stack.count() == 0)
+            {
+                return false;
+            }
+
+            element = m_stack.top();
+            m_stack.pop();
+
+            return true;
+        }
+
+    private:
+        std::mutex m_mutex;
+        Stack<T> m_stack;
+};
+
+
+template <class Queue>
+double throughput(Queue& queue, std::size_t producers, std::size_t consumers, std::size_t items)
+{
+    std::atomic<std::size_t> consumed { 0 };
+    std::vector<std::thread> threads;
+
+    auto start { std::chrono::steady_clock::now() };
+
+    for (std::size_t p { 0 }; p < producers; ++p)
+    {
+        threads.emplace_back([&queue, items, producers]
+        {
+            for (std::size_t i { 0 }; i < items / producers; ++i)
+            {
+                while (!queue.tryPush(i))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    for (std::size_t c { 0 }; c < consumers; ++c)
+    {
+        threads.emplace_back([&queue, &consumed, items, producers]
+        {
+            std::size_t element { 0 };
+
+            while (consumed.load(std::memory_order_relaxed) < items / producers * producers)
+            {
+                if (queue.tryPop(element))
+                {
+                    consumed.fetch_add(1, std::memory_order_relaxed);
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    std::chrono::duration<double> elapsed { std::chrono::steady_clock::now() - start };
+
+    return items / elapsed.count();
+}
+
+
+template <class Queue>
+double latency(Queue& ping, Queue& pong, std::size_t roundTrips)
+{
+    std::thread echo { [&ping, &pong, roundTrips]
+    {
+        std::size_t element { 0 };
+
+        for (std::size_t i { 0 }; i < roundTrips; ++i)
+        {
+            while (!ping.tryPop(element))
+            {
+                std::this_thread::yield();
+            }
+
+            while (!pong.tryPush(element))
+            {
+                std::this_thread::yield();
+            }
+        }
+    } };
+
+    std::size_t element { 0 };
+    auto start { std::chrono::steady_clock::now() };
+
+    for (std::size_t i { 0 }; i < roundTrips; ++i)
+    {
+        while (!ping.tryPush(i))
+        {
+            std::this_thread::yield();
+        }
+
+        while (!pong.tryPop(element))
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    std::chrono::duration<double, std::nano> elapsed { std::chrono::steady_clock::now() - start };
+    echo.join();
+
+    return elapsed.count() / roundTrips / 2;
+}
+
+
+int main()
+{
+    constexpr std::size_t items { 1'000'000 };
+    constexpr std::size_t roundTrips { 100'000 };
+    constexpr std::size_t size { 1024 };
+
+    {
+        SpscQueue<std::size_t> queue { size };
+        SpscQueue<std::size_t> ping { size }, pong { size };
+
+        std::cout << "SPSC queue,   1P/1C: " << throughput(queue, 1, 1, items) << " items/s, "
+                  << latency(ping, pong, roundTrips) << " ns one-way\n";
+    }
+
+    {
+        MpmcQueue<std::size_t> queue { size };
+        MpmcQueue<std::size_t> ping { size }, pong { size };
+
+        std::cout << "MPMC queue,   1P/1C: " << throughput(queue, 1, 1, items) << " items/s, "
+                  << latency(ping, pong, roundTrips) << " ns one-way\n";
+        std::cout << "MPMC queue,   4P/4C: " << throughput(queue, 4, 4, items) << " items/s\n";
+    }
+
+    {
+        LockedStack<std::size_t> queue;
+        LockedStack<std::size_t> ping, pong;
+
+        std::cout << "Locked Stack, 1P/1C: " << throughput(queue, 1, 1, items) << " items/s, "
+                  << latency(ping, pong, roundTrips) << " ns one-way\n";
+        std::cout << "Locked Stack, 4P/4C: " << throughput(queue, 4, 4, items) << " items/s\n";
+    }
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Copy-on-write.
+ *
+ * The Stack copy constructor above deep-copies every element, which is wasted work when the copy is a snapshot that's never
+ * modified. Because Stack already keeps all of its state in a separate StackImpl, we can let copies share one StackImpl
+ * and keep a reference count next to it. SharedStack does exactly that. A copy is then just a pointer copy and an
+ * increment, and the elements are only duplicated the first time one of the sharers tries to change them.
+ *
+ * The count is atomic, so copies of the same snapshot may live on different threads. A single SharedStack object is still
+ * no more thread-safe than before.
+*/
+
+template <class T>
+class SharedImpl
+{
+    public:
+        SharedImpl(std::size_t size)
+            : m_impl { size }, m_references { 1 }, m_unshareable { false } { }
+
+        StackImpl<T> m_impl;
+        std::atomic<std::size_t> m_references;
+        bool m_unshareable;                                 // A reference into m_impl has been handed out
+};
+
+template <class T>
+class SharedStack
+{
+    public:
+        SharedStack(std::size_t size = 0);
+        ~SharedStack();
+
+        SharedStack(const SharedStack& other);
+        SharedStack& operator = (const SharedStack& other);
+
+        std::size_t count() const;
+        void push(const T& element);
+        const T& top() const;
+        T& top();
+        void pop();
+
+    private:
+        bool shared() const;
+        std::unique_ptr<SharedImpl<T>> clone(std::size_t size, std::size_t used) const;
+        void adopt(std::unique_ptr<SharedImpl<T>> impl) noexcept;
+        void release() noexcept;
+
+        SharedImpl<T>* m_p_shared;
+};
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Construction, copying and destruction.
+ *
+ * Copying a shareable buffer can no longer throw. Copying an unshareable one (see the mutators) is a deep copy again, made
+ * with clone(), and copy assignment is copy-and-swap, so it still gives the strong guarantee. The last SharedStack to let
+ * go of a SharedImpl deletes it, and StackImpl's destructor destroys the elements exactly as before.
+ *
+ * The decrement uses acq_rel so that whichever thread ends up deleting the buffer sees every write other sharers made to
+ * it before they let go.
+*/
+
+template <class T>
+SharedStack<T>::SharedStack(std::size_t size)
+    : m_p_shared { new SharedImpl<T> { size } } { }
+
+
+template <class T>
+SharedStack<T>::~SharedStack()
+{
+    release();
+}
+
+
+template <class T>
+void SharedStack<T>::release() noexcept
+{
+    if (m_p_shared->m_references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        delete m_p_shared;
+    }
+}
+
+
+template <class T>
+SharedStack<T>::SharedStack(const SharedStack& other)
+    : m_p_shared { other.m_p_shared }
+{
+    if (m_p_shared->m_unshareable)
+    {
+        m_p_shared = other.clone(m_p_shared->m_impl.m_size, m_p_shared->m_impl.m_used).release();
+    }
+    else
+    {
+        m_p_shared->m_references.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+
+template <class T>
+SharedStack<T>& SharedStack<T>::operator = (const SharedStack& other)
+{
+    SharedStack temp { other };
+    std::swap(m_p_shared, temp.m_p_shared);
+
+    return *this;
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * clone() and adopt().
+ *
+ * Every mutation that finds the buffer shared follows the same pattern as push() in Item 13: clone() builds a private copy
+ * off to the side, where a throwing T constructor only destroys the half-built copy, and adopt() then commits it with
+ * operations that can't throw. If anything goes wrong, the SharedStack still shares the old buffer and nothing has changed.
+*/
+
+template <class T>
+bool SharedStack<T>::shared() const
+{
+    return m_p_shared->m_references.load(std::memory_order_acquire) != 1;
+}
+
+
+template <class T>
+std::unique_ptr<SharedImpl<T>> SharedStack<T>::clone(std::size_t size, std::size_t used) const
+{
+    std::unique_ptr<SharedImpl<T>> copy { new SharedImpl<T> { size } };
+    StackImpl<T>& impl { copy->m_impl };
+
+    while (impl.m_used < used)
+    {
+        construct(impl.m_v + impl.m_used, m_p_shared->m_impl.m_v[impl.m_used]);
+        ++impl.m_used;
+    }
+
+    return copy;
+}
+
+
+template <class T>
+void SharedStack<T>::adopt(std::unique_ptr<SharedImpl<T>> impl) noexcept
+{
+    release();
+    m_p_shared = impl.release();
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Mutators.
+ *
+ * A sole owner mutates in place, exactly like the non-sharing Stack. A sharer first gets its own copy, and folds any growth
+ * into that same copy so the elements are only copied once.
+ *
+ * The non-const top() counts as a mutation, because the caller may write through the reference. It's also the trap that
+ * made the standard library give up on copy-on-write strings: if the buffer were shared later, writing through that
+ * reference would change every copy. So top() marks the buffer unshareable, and copies of it are made the old way,
+ * element by element. The mark lasts as long as the buffer does; a push() that grows moves the elements into a fresh,
+ * shareable buffer, which invalidates the reference anyway.
+*/
+
+template <class T>
+std::size_t SharedStack<T>::count() const
+{
+    return m_p_shared->m_impl.m_used;
+}
+
+
+template <class T>
+void SharedStack<T>::push(const T& element)
+{
+    StackImpl<T>& impl { m_p_shared->m_impl };
+
+    if (!shared() && impl.m_used < impl.m_size)
+    {
+        construct(impl.m_v + impl.m_used, element);
+        ++impl.m_used;
+
+        return;
+    }
+
+    std::unique_ptr<SharedImpl<T>> copy { clone(impl.m_used == impl.m_size ? impl.m_size * 2 + 1 : impl.m_size,
+                                                impl.m_used) };
+
+    construct(copy->m_impl.m_v + copy->m_impl.m_used, element);
+    ++copy->m_impl.m_used;
+
+    adopt(std::move(copy));
+}
+
+
+template <class T>
+const T& SharedStack<T>::top() const
+{
+    if (m_p_shared->m_impl.m_used == 0)
+    {
+        throw("Empty Stack");
+    }
+
+    return m_p_shared->m_impl.m_v[m_p_shared->m_impl.m_used - 1];
+}
+
+
+template <class T>
+T& SharedStack<T>::top()
+{
+    if (m_p_shared->m_impl.m_used == 0)
+    {
+        throw("Empty Stack");
+    }
+
+    if (shared())
+    {
+        adopt(clone(m_p_shared->m_impl.m_size, m_p_shared->m_impl.m_used));
+    }
+
+    m_p_shared->m_unshareable = true;
+
+    return m_p_shared->m_impl.m_v[m_p_shared->m_impl.m_used - 1];
+}
+
+
+template <class T>
+void SharedStack<T>::pop()
+{
+    StackImpl<T>& impl { m_p_shared->m_impl };
+
+    if (impl.m_used == 0)
+    {
+        throw("Pop from an empty stack.");
+    }
+
+    if (shared())
+    {
+        // No point copying the element we're about to drop
+        adopt(clone(impl.m_size, impl.m_used - 1));
+    }
+    else
+    {
+        --impl.m_used;
+        destroy(impl.m_v + impl.m_used);
+    }
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Spilling to disk.
+ *
+ * A depth-first search can push far more than fits in memory, but it only ever works near the top of its stack. The bulk
+ * of the elements sit untouched for a long time, and when they are needed again it's in a perfectly predictable order.
+ *
+ * SpillingStack stores its elements in fixed-size segments. Only the top few (the window) are kept in memory; when the
+ * window grows past m_resident segments, its lowest segment is handed to a background thread that writes it to a
+ * temporary file and then frees it. When pops shrink the window to half its size, the segment just below it is read back,
+ * again in the background. By the time pop() reaches a segment, it is normally in memory already, and push() and pop()
+ * never wait for the disk.
+ *
+ * Segments are written out as raw bytes, so T has to be trivially copyable. This also means elements never need to be
+ * destroyed, and the buffers are plain uninitialized storage, as in StackImpl.
+*/
+
+template <class T>
+class SpillingStack
+{
+    static_assert(std::is_trivially_copyable_v<T>, "SpillingStack writes its elements to disk as raw bytes");
+
+    public:
+        SpillingStack(std::size_t segmentSize = 65536, std::size_t resident = 8);
+        ~SpillingStack();
+
+        // No copying allowed
+        SpillingStack(const SpillingStack& other) = delete;
+        SpillingStack& operator = (const SpillingStack& other) = delete;
+
+        std::size_t count() const;
+        void push(const T& element);
+        T& top();
+        void pop();
+
+    private:
+        // A segment's contents are in memory (resident), on disk (spilled), on their way between the two, or irrelevant
+        enum class State { empty, resident, writing, reclaiming, spilled, reading };
+
+        struct Segment
+        {
+            T* m_p_data;
+            State m_state;
+        };
+
+        T* allocate();
+        void release(T* buffer) noexcept;
+
+        T* open(std::size_t index);
+        void close(std::size_t index, std::unique_lock<std::mutex>& lock);
+        T* resident(std::size_t index, std::unique_lock<std::mutex>& lock);
+        void spill(std::size_t index, std::unique_lock<std::mutex>& lock);
+        void prefetch(std::size_t index);
+        void balance(std::unique_lock<std::mutex>& lock);
+
+        void transfer();
+
+        const std::size_t m_segmentSize;
+        const std::size_t m_resident;
+        std::size_t m_used { 0 };
+        std::size_t m_lowest { 0 };                             // The lowest segment in the window
+        T* m_p_top { nullptr };                                 // The top segment, if it's known to be resident
+
+        std::vector<Segment> m_segments;
+        std::vector<T*> m_spare;
+        std::unique_ptr<std::FILE, int (*)(std::FILE*)> m_p_file;
+
+        std::mutex m_mutex;
+        std::condition_variable m_changed;
+        std::deque<std::size_t> m_jobs;
+        bool m_stopping { false };
+        std::thread m_io;
+};
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Construction and destruction.
+ *
+ * std::tmpfile() gives us a file that disappears when it's closed, even if we crash. Segment i always lives at offset
+ * i * m_segmentSize * sizeof(T), so the file never needs an allocator of its own.
+ *
+ * The destructor lets the I/O thread finish whatever it has been given before it joins it; only then do the buffers stop
+ * being shared with it.
+*/
+
+template <class T>
+SpillingStack<T>::SpillingStack(std::size_t segmentSize, std::size_t resident)
+    : m_segmentSize { segmentSize }, m_resident { std::max<std::size_t>(resident, 1) },
+      m_p_file { std::tmpfile(), &std::fclose }
+{
+    assert(segmentSize > 0);
+
+    if (!m_p_file)
+    {
+        throw("Cannot create a spill file.");
+    }
+
+    m_spare.reserve(2);
+    m_io = std::thread { &SpillingStack::transfer, this };
+}
+
+
+template <class T>
+SpillingStack<T>::~SpillingStack()
+{
+    {
+        std::lock_guard<std::mutex> lock { m_mutex };
+        m_stopping = true;
+    }
+
+    m_changed.notify_all();
+    m_io.join();
+
+    for (const Segment& segment : m_segments)
+    {
+        operator delete(segment.m_p_data);
+    }
+
+    for (T* buffer : m_spare)
+    {
+        operator delete(buffer);
+    }
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Buffers.
+ *
+ * Segments are opened and closed over and over when the stack oscillates around a segment boundary, so we keep a couple of
+ * freed buffers around instead of going back to the allocator every time. m_spare has room reserved for them, so
+ * release() can't throw.
+ *
+ * Both are called with the lock held, since the I/O thread releases buffers too.
+*/
+
+template <class T>
+T* SpillingStack<T>::allocate()
+{
+    if (m_spare.empty())
+    {
+        return static_cast<T*>(operator new(sizeof(T) * m_segmentSize));
+    }
+
+    T* buffer { m_spare.back() };
+    m_spare.pop_back();
+
+    return buffer;
+}
+
+
+template <class T>
+void SpillingStack<T>::release(T* buffer) noexcept
+{
+    if (m_spare.size() < m_spare.capacity())
+    {
+        m_spare.push_back(buffer);
+    }
+    else
+    {
+        operator delete(buffer);
+    }
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Moving segments in and out.
+ *
+ * Every segment in flight has exactly one job queued for it. Each state change below keeps it that way:
+ *
+ * - spill() queues a write for a resident segment. If the segment is still being read in, it waits for that first.
+ * - prefetch() queues a read for a spilled segment. If the segment is still being written out, the data is still in
+ *   memory, so it just cancels the release (reclaiming) and lets the write finish.
+ * - resident() is the only one that waits for a segment to arrive, and the only one that fails loudly if it can't.
+ * - close() throws a popped segment's contents away, after any job for it has finished with the buffer.
+ *
+ * spill() and prefetch() queue the job before changing any state, so if that throws nothing has changed.
+*/
+
+template <class T>
+T* SpillingStack<T>::open(std::size_t index)
+{
+    if (index == m_segments.size())
+    {
+        m_segments.push_back({ nullptr, State::empty });
+    }
+
+    T* buffer { allocate() };
+    m_segments[index] = { buffer, State::resident };
+
+    return buffer;
+}
+
+
+template <class T>
+void SpillingStack<T>::close(std::size_t index, std::unique_lock<std::mutex>& lock)
+{
+    m_changed.wait(lock, [this, index]
+    {
+        State state { m_segments[index].m_state };
+
+        return state != State::writing && state != State::reclaiming && state != State::reading;
+    });
+
+    if (m_segments[index].m_p_data)
+    {
+        release(m_segments[index].m_p_data);
+    }
+
+    m_segments[index] = { nullptr, State::empty };
+}
+
+
+template <class T>
+T* SpillingStack<T>::resident(std::size_t index, std::unique_lock<std::mutex>& lock)
+{
+    prefetch(index);
+    m_lowest = std::min(m_lowest, index);
+
+    m_changed.wait(lock, [this, index]
+    {
+        State state { m_segments[index].m_state };
+
+        return state != State::reclaiming && state != State::reading;
+    });
+
+    if (m_segments[index].m_state != State::resident)
+    {
+        throw("Cannot read back a spilled segment.");
+    }
+
+    return m_segments[index].m_p_data;
+}
+
+
+template <class T>
+void SpillingStack<T>::spill(std::size_t index, std::unique_lock<std::mutex>& lock)
+{
+    m_changed.wait(lock, [this, index] { return m_segments[index].m_state != State::reading; });
+
+    Segment& segment { m_segments[index] };
+
+    if (segment.m_state == State::resident)
+    {
+        m_jobs.push_back(index);
+        segment.m_state = State::writing;
+        m_changed.notify_all();
+    }
+    else if (segment.m_state == State::reclaiming)
+    {
+        segment.m_state = State::writing;
+    }
+}
+
+
+template <class T>
+void SpillingStack<T>::prefetch(std::size_t index)
+{
+    Segment& segment { m_segments[index] };
+
+    if (segment.m_state == State::spilled)
+    {
+        T* buffer { allocate() };
+
+        try
+        {
+            m_jobs.push_back(index);
+        }
+        catch ( ... )
+        {
+            release(buffer);
+            throw;
+        }
+
+        segment = { buffer, State::reading };
+        m_changed.notify_all();
+    }
+    else if (segment.m_state == State::writing)
+    {
+        segment.m_state = State::reclaiming;
+    }
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * balance().
+ *
+ * Called whenever the top segment changes. The window may grow to m_resident segments before we start spilling, and has to
+ * shrink to half that before we start prefetching, so a stack that oscillates across a segment boundary doesn't move
+ * anything at all. Prefetching half a window ahead gives the I/O thread as long as it takes to pop m_resident / 2
+ * segments to bring the next one back.
+ *
+ * Both directions are only hints. If one of them fails, the segment simply stays where it is, and resident() deals with
+ * it if and when it's needed. That keeps pop() from ever failing after it has popped.
+*/
+
+template <class T>
+void SpillingStack<T>::balance(std::unique_lock<std::mutex>& lock)
+{
+    if (m_used == 0)
+    {
+        m_lowest = 0;
+
+        return;
+    }
+
+    std::size_t top { (m_used - 1) / m_segmentSize };
+    m_lowest = std::min(m_lowest, top + 1);
+
+    try
+    {
+        while (top - m_lowest + 1 > m_resident)
+        {
+            spill(m_lowest, lock);
+            ++m_lowest;
+        }
+
+        while (m_lowest > 0 && top - m_lowest + 1 < (m_resident + 1) / 2)
+        {
+            prefetch(m_lowest - 1);
+            --m_lowest;
+        }
+    }
+    catch ( ... )
+    {
+    }
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * The I/O thread.
+ *
+ * It takes jobs in order and does the reading and writing without holding the lock, so the owner can keep pushing and
+ * popping meanwhile. A write that fails leaves the segment resident: we lose the memory we hoped to save, but no data. A
+ * read that fails leaves it spilled, so resident() reports the error and a later call can try again.
+*/
+
+template <class T>
+void SpillingStack<T>::transfer()
+{
+    const int file { fileno(m_p_file.get()) };
+    const std::size_t bytes { sizeof(T) * m_segmentSize };
+
+    std::unique_lock<std::mutex> lock { m_mutex };
+
+    while (true)
+    {
+        m_changed.wait(lock, [this] { return m_stopping || !m_jobs.empty(); });
+
+        if (m_jobs.empty())
+        {
+            return;
+        }
+
+        std::size_t index { m_jobs.front() };
+        m_jobs.pop_front();
+
+        State state { m_segments[index].m_state };
+        T* buffer { m_segments[index].m_p_data };
+
+        if (state == State::reclaiming)
+        {
+            // Reclaimed before we even started writing it
+            m_segments[index].m_state = State::resident;
+            m_changed.notify_all();
+
+            continue;
+        }
+
+        lock.unlock();
+
+        char* data { reinterpret_cast<char*>(buffer) };
+        std::size_t left { bytes };
+        off_t offset { static_cast<off_t>(index * bytes) };
+
+        while (left > 0)
+        {
+            ssize_t done { state == State::reading ? pread(file, data, left, offset) : pwrite(file, data, left, offset) };
+
+            if (done <= 0)
+            {
+                if (done < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+
+                break;
+            }
+
+            data += done;
+            left -= done;
+            offset += done;
+        }
+
+        lock.lock();
+
+        Segment& segment { m_segments[index] };
+
+        if (state == State::reading)
+        {
+            if (left == 0)
+            {
+                segment.m_state = State::resident;
+            }
+            else
+            {
+                release(buffer);
+                segment = { nullptr, State::spilled };
+            }
+        }
+        else if (left == 0 && segment.m_state == State::writing)
+        {
+            release(buffer);
+            segment = { nullptr, State::spilled };
+        }
+        else
+        {
+            segment.m_state = State::resident;
+        }
+
+        m_changed.notify_all();
+    }
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * The Stack interface.
+ *
+ * Within a segment, push(), top() and pop() go straight to m_p_top and don't take the lock at all. Only crossing a segment
+ * boundary involves the I/O thread.
+ *
+ * push() copies the element before it calls balance(), so "s.push(s.top())" is safe even if the segment holding the
+ * original is about to be spilled. pop() never needs the contents of the segment it pops into, so it doesn't wait for
+ * them; top() or the next push() will, if they're still on their way.
+*/
+
+template <class T>
+std::size_t SpillingStack<T>::count() const
+{
+    return m_used;
+}
+
+
+template <class T>
+void SpillingStack<T>::push(const T& element)
+{
+    bool opening { m_used % m_segmentSize == 0 };
+
+    if (opening || !m_p_top)
+    {
+        std::unique_lock<std::mutex> lock { m_mutex };
+        std::size_t index { m_used / m_segmentSize };
+
+        m_p_top = opening ? open(index) : resident(index, lock);
+    }
+
+    m_p_top[m_used % m_segmentSize] = element;
+    ++m_used;
+
+    if (opening)
+    {
+        std::unique_lock<std::mutex> lock { m_mutex };
+        balance(lock);
+    }
+}
+
+
+template <class T>
+T& SpillingStack<T>::top()
+{
+    if (m_used == 0)
+    {
+        throw("Empty Stack");
+    }
+
+    if (!m_p_top)
+    {
+        std::unique_lock<std::mutex> lock { m_mutex };
+        m_p_top = resident((m_used - 1) / m_segmentSize, lock);
+    }
+
+    return m_p_top[(m_used - 1) % m_segmentSize];
+}
+
+
+template <class T>
+void SpillingStack<T>::pop()
+{
+    if (m_used == 0)
+    {
+        throw("Pop from an empty stack.");
+    }
+
+    --m_used;
+
+    if (m_used % m_segmentSize == 0)
+    {
+        std::unique_lock<std::mutex> lock { m_mutex };
+
+        close(m_used / m_segmentSize, lock);
+        m_p_top = nullptr;
+        balance(lock);
+    }
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Snapshots.
+ *
+ * Checkpointing a Stack by pushing its elements through a text stream one at a time formats and parses every element, and
+ * reloading it goes through push() and all of its growths. But everything a Stack holds is already in one contiguous
+ * StackImpl buffer. For trivially copyable T, a snapshot can simply be that buffer behind a small header:
+ *
+ * - save() writes the header and the buffer with a single writev(), to a temporary file that is renamed over the old
+ *   snapshot only once it's safely on disk. A crash mid-checkpoint leaves the previous snapshot intact.
+ * - load() allocates a StackImpl of exactly the right size and reads the whole payload into it with one read. No element
+ *   is constructed one by one, and there are no growths.
+ * - SnapshotView maps a snapshot read-only and exposes the elements in place, without copying anything at all. The pages
+ *   come straight from the page cache, and only the ones actually touched are read.
+ *
+ * Any other T goes through Serializer<T>, which users specialize for their own types. The serialized elements are still
+ * gathered into one buffer and written, and read back, in one go.
+*/
+
+struct SnapshotHeader
+{
+    char m_magic[8];
+    std::uint32_t m_version;
+    std::uint32_t m_elementSize;                            // sizeof(T) for a raw snapshot, 0 for a serialized one
+    std::uint64_t m_count;
+    std::uint64_t m_bytes;                                  // Size of the payload following the header
+};
+
+constexpr char snapshotMagic[8] { 'S', 'T', 'K', 'S', 'N', 'A', 'P', '\0' };
+constexpr std::uint32_t snapshotVersion { 1 };
+
+
+// Specialize for every T that isn't trivially copyable. minimumSize is the fewest bytes an element can be saved in.
+template <class T>
+struct Serializer;
+
+template <>
+struct Serializer<std::string>
+{
+    static constexpr std::size_t minimumSize { sizeof(std::uint64_t) };
+
+    static void save(const std::string& element, std::string& out)
+    {
+        std::uint64_t length { element.size() };
+
+        out.append(reinterpret_cast<const char*>(&length), sizeof(length));
+        out.append(element);
+    }
+
+    static std::string load(const char*& in, const char* end)
+    {
+        std::uint64_t length;
+
+        if (static_cast<std::size_t>(end - in) < sizeof(length))
+        {
+            throw("Truncated snapshot.");
+        }
+
+        std::memcpy(&length, in, sizeof(length));
+        in += sizeof(length);
+
+        if (static_cast<std::uint64_t>(end - in) < length)
+        {
+            throw("Truncated snapshot.");
+        }
+
+        std::string element(in, length);
+        in += length;
+
+        return element;
+    }
+};
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Files.
+ *
+ * writeSnapshot() takes care of the temporary file, the partial writes writev() is allowed to do, and fsync(). Reading
+ * goes through SnapshotFile, which validates the header and owns the descriptor, so every early exit closes it.
+*/
+
+void writeSnapshot(const std::string& path, const SnapshotHeader& header, const void* payload)
+{
+    std::string temporary { path + ".tmp" };
+    int file { open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644) };
+
+    if (file < 0)
+    {
+        throw("Cannot create snapshot file.");
+    }
+
+    iovec parts[2]
+    {
+        { const_cast<SnapshotHeader*>(&header), sizeof(header) },
+        { const_cast<void*>(payload), static_cast<std::size_t>(header.m_bytes) }
+    };
+
+    int part { 0 };
+
+    while (part < 2)
+    {
+        ssize_t written { writev(file, parts + part, 2 - part) };
+
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            break;
+        }
+
+        while (part < 2 && static_cast<std::size_t>(written) >= parts[part].iov_len)
+        {
+            written -= parts[part].iov_len;
+            ++part;
+        }
+
+        if (part < 2)
+        {
+            parts[part].iov_base = static_cast<char*>(parts[part].iov_base) + written;
+            parts[part].iov_len -= written;
+        }
+    }
+
+    bool stored { part == 2 && fsync(file) == 0 };
+    stored = close(file) == 0 && stored;
+
+    if (!stored || std::rename(temporary.c_str(), path.c_str()) != 0)
+    {
+        unlink(temporary.c_str());
+        throw("Cannot write snapshot.");
+    }
+}
+
+
+class SnapshotFile
+{
+    public:
+        SnapshotFile(const std::string& path, std::uint32_t elementSize);
+        ~SnapshotFile();
+
+        // No copying allowed
+        SnapshotFile(const SnapshotFile& other) = delete;
+        SnapshotFile& operator = (const SnapshotFile& other) = delete;
+
+        const SnapshotHeader& header() const;
+        int descriptor() const;
+        bool read(void* buffer) const;
+
+    private:
+        bool read(void* buffer, std::size_t bytes, off_t offset) const;
+
+        int m_file;
+        SnapshotHeader m_header;
+};
+
+
+SnapshotFile::SnapshotFile(const std::string& path, std::uint32_t elementSize)
+    : m_file { open(path.c_str(), O_RDONLY | O_CLOEXEC) }, m_header { }
+{
+    if (m_file < 0)
+    {
+        throw("Cannot open snapshot file.");
+    }
+
+    struct stat status { };
+
+    bool valid { fstat(m_file, &status) == 0 && read(&m_header, sizeof(m_header), 0) &&
+                 std::memcmp(m_header.m_magic, snapshotMagic, sizeof(snapshotMagic)) == 0 &&
+                 m_header.m_version == snapshotVersion && m_header.m_elementSize == elementSize &&
+                 static_cast<std::uint64_t>(status.st_size) == sizeof(m_header) + m_header.m_bytes &&
+                 (elementSize == 0 ||
+                  (m_header.m_bytes % elementSize == 0 && m_header.m_count == m_header.m_bytes / elementSize)) };
+
+    if (!valid)
+    {
+        close(m_file);
+        throw("Not a snapshot of this type.");
+    }
+}
+
+
+SnapshotFile::~SnapshotFile()
+{
+    close(m_file);
+}
+
+
+const SnapshotHeader& SnapshotFile::header() const
+{
+    return m_header;
+}
+
+
+int SnapshotFile::descriptor() const
+{
+    return m_file;
+}
+
+
+bool SnapshotFile::read(void* buffer) const
+{
+    return read(buffer, m_header.m_bytes, sizeof(m_header));
+}
+
+
+bool SnapshotFile::read(void* buffer, std::size_t bytes, off_t offset) const
+{
+    char* data { static_cast<char*>(buffer) };
+
+    while (bytes > 0)
+    {
+        ssize_t done { pread(m_file, data, bytes, offset) };
+
+        if (done <= 0)
+        {
+            if (done < 0 && errno == EINTR)
+            {
+                continue;
+            }
+
+            return false;
+        }
+
+        data += done;
+        bytes -= done;
+        offset += done;
+    }
+
+    return true;
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Saving and loading a StackImpl.
+ *
+ * loadSnapshot() builds the new buffer in a temporary StackImpl and swaps it in only when it's complete, so it gives the
+ * strong guarantee: a missing, corrupt or truncated snapshot leaves impl untouched. It also means a Serializer that throws
+ * halfway needs no cleanup; the temporary destroys whatever it had constructed.
+ *
+ * The count in the header sizes that temporary, so it's checked against the payload first: a raw snapshot must hold
+ * exactly count elements, and a serialized one at least minimumSize bytes per element. A serialized payload with bytes
+ * left over after the last element is rejected as well.
+*/
+
+template <class T>
+void saveSnapshot(const StackImpl<T>& impl, const std::string& path)
+{
+    SnapshotHeader header { { }, snapshotVersion, 0, impl.m_used, 0 };
+    std::memcpy(header.m_magic, snapshotMagic, sizeof(snapshotMagic));
+
+    if constexpr (std::is_trivially_copyable_v<T>)
+    {
+        header.m_elementSize = sizeof(T);
+        header.m_bytes = sizeof(T) * impl.m_used;
+
+        writeSnapshot(path, header, impl.m_v);
+    }
+    else
+    {
+        std::string payload;
+
+        for (std::size_t i { 0 }; i < impl.m_used; ++i)
+        {
+            Serializer<T>::save(impl.m_v[i], payload);
+        }
+
+        header.m_bytes = payload.size();
+
+        writeSnapshot(path, header, payload.data());
+    }
+}
+
+
+template <class T>
+void loadSnapshot(StackImpl<T>& impl, const std::string& path)
+{
+    constexpr bool raw { std::is_trivially_copyable_v<T> };
+
+    SnapshotFile file { path, raw ? sizeof(T) : 0 };
+    std::uint64_t count { file.header().m_count };
+
+    if constexpr (!raw)
+    {
+        if (count > file.header().m_bytes / Serializer<T>::minimumSize)
+        {
+            throw("Corrupt snapshot.");
+        }
+    }
+
+    if (count > SIZE_MAX / sizeof(T))
+    {
+        throw("Corrupt snapshot.");
+    }
+
+    StackImpl<T> temp { static_cast<std::size_t>(count) };
+
+    if constexpr (raw)
+    {
+        if (!file.read(temp.m_v))
+        {
+            throw("Cannot read snapshot.");
+        }
+
+        temp.m_used = temp.m_size;
+    }
+    else
+    {
+        std::string payload(file.header().m_bytes, '\0');
+
+        if (!file.read(payload.data()))
+        {
+            throw("Cannot read snapshot.");
+        }
+
+        const char* in { payload.data() };
+        const char* end { in + payload.size() };
+
+        while (temp.m_used < temp.m_size)
+        {
+            construct(temp.m_v + temp.m_used, Serializer<T>::load(in, end));
+            ++temp.m_used;
+        }
+
+        if (in != end)
+        {
+            throw("Corrupt snapshot.");
+        }
+    }
+
+    impl.swap(temp);
+}
+
+
+template <class T>
+void Stack<T>::save(const std::string& path) const
+{
+    saveSnapshot(m_impl, path);
+}
+
+
+template <class T>
+void Stack<T>::load(const std::string& path)
+{
+    loadSnapshot(m_impl, path);
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * SnapshotView.
+ *
+ * A read-only window onto a raw snapshot, for when the checkpointed elements only need to be looked at. Opening one costs
+ * an mmap() no matter how big the snapshot is. The mapping stays valid after the descriptor is closed, and it's shared, so
+ * several processes viewing the same snapshot share one copy of it in memory.
+ *
+ * The payload starts right after the header, which mmap() places at a page boundary, so it's suitably aligned for any T
+ * whose alignment divides the header size.
+*/
+
+template <class T>
+class SnapshotView
+{
+    static_assert(std::is_trivially_copyable_v<T>, "Only raw snapshots can be viewed in place");
+    static_assert(sizeof(SnapshotHeader) % alignof(T) == 0, "The payload wouldn't be aligned for T");
+
+    public:
+        explicit SnapshotView(const std::string& path);
+        ~SnapshotView();
+
+        // No copying allowed
+        SnapshotView(const SnapshotView& other) = delete;
+        SnapshotView& operator = (const SnapshotView& other) = delete;
+
+        std::size_t count() const;
+        const T* begin() const;
+        const T* end() const;
+        const T& operator [] (std::size_t index) const;
+
+    private:
+        void* m_p_mapping;
+        std::size_t m_length;
+        std::size_t m_count;
+};
+
+
+template <class T>
+SnapshotView<T>::SnapshotView(const std::string& path)
+    : m_p_mapping { nullptr }, m_length { 0 }, m_count { 0 }
+{
+    SnapshotFile file { path, sizeof(T) };
+
+    m_length = sizeof(SnapshotHeader) + file.header().m_bytes;
+    m_count = file.header().m_count;
+    m_p_mapping = mmap(nullptr, m_length, PROT_READ, MAP_SHARED, file.descriptor(), 0);
+
+    if (m_p_mapping == MAP_FAILED)
+    {
+        throw("Cannot map snapshot.");
+    }
+}
+
+
+template <class T>
+SnapshotView<T>::~SnapshotView()
+{
+    munmap(m_p_mapping, m_length);
+}
+
+
+template <class T>
+std::size_t SnapshotView<T>::count() const
+{
+    return m_count;
+}
+
+
+template <class T>
+const T* SnapshotView<T>::begin() const
+{
+    return reinterpret_cast<const T*>(static_cast<const char*>(m_p_mapping) + sizeof(SnapshotHeader));
+}
+
+
+template <class T>
+const T* SnapshotView<T>::end() const
+{
+    return begin() + m_count;
+}
+
+
+template <class T>
+const T& SnapshotView<T>::operator [] (std::size_t index) const
+{
+    return begin()[index];
 }
\ No newline at end of file
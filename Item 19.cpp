@@ -1,5 +1,26 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <new>
+#include <optional>
+#include <random>
+#include <stack>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <sys/resource.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
 /**
  * Item 19 - Code Complexity - Part 2
  *
@@ -27,8 +48,39 @@ class Employee
         std::int32_t salary() const;
         std::string first() const;
         std::string last() const;
+
+    private:
+        std::string m_title;
+        std::int32_t m_salary { 0 };
+        std::string m_first;
+        std::string m_last;
 };
 
+
+std::string Employee::title() const
+{
+    return m_title;
+}
+
+
+std::int32_t Employee::salary() const
+{
+    return m_salary;
+}
+
+
+std::string Employee::first() const
+{
+    return m_first;
+}
+
+
+std::string Employee::last() const
+{
+    return m_last;
+}
+
+
 std::string evaluate(Employee employee)
 {
     if (employee.title() == "CEO" || employee.salary() > 100'000)
@@ -60,7 +112,7 @@ std::string evaluate(Employee employee)
  * Replace std::endl with a newline character in order to get the entire string into one operator << call.
 */
 
-std::string evaluate(Employee employee)
+std::string evaluateAttempt1(Employee employee)
 {
     std::string result { employee.first() + " " + employee.last() };
 
@@ -71,4 +123,903 @@ std::string evaluate(Employee employee)
     }
 
     return result;
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Measuring the trade-off.
+ *
+ * "Often requires you to trade off performance" is easy to say and hard to check. The harness below runs the three Stack
+ * designs from Items 10, 13 and 14 over element types whose copy constructor and copy assignment throw at configurable
+ * rates. It reports:
+ *
+ * - Throughput, with the time spent on operations that succeeded and on operations that threw measured separately.
+ * - For every injected failure, whether the Stack was left unchanged (strong guarantee), changed but still usable (basic
+ *   guarantee only), or broken.
+ *
+ * The three designs are condensed copies of the originals, each in its own namespace so they can sit side by side. The
+ * Item 09/10 copy constructor and assignment pass newCopy()'s size arguments in the right order here; the originals have
+ * them swapped.
+*/
+
+class InjectedFault { };
+
+class FaultInjector
+{
+    public:
+        static void configure(double copyRate, double assignRate)
+        {
+            s_copy = std::bernoulli_distribution { copyRate };
+            s_assign = std::bernoulli_distribution { assignRate };
+            s_engine.seed(2024);
+        }
+
+        static void copy()
+        {
+            if (s_enabled && s_copy(s_engine))
+            {
+                throw InjectedFault { };
+            }
+        }
+
+        static void assign()
+        {
+            if (s_enabled && s_assign(s_engine))
+            {
+                throw InjectedFault { };
+            }
+        }
+
+        // Turns injection off for as long as it lives, so the harness can take snapshots
+        class Suspend
+        {
+            public:
+                Suspend() : m_was { s_enabled } { s_enabled = false; }
+                ~Suspend() { s_enabled = m_was; }
+
+            private:
+                bool m_was;
+        };
+
+    private:
+        static inline bool s_enabled { true };
+        static inline std::mt19937_64 s_engine { };
+        static inline std::bernoulli_distribution s_copy { 0.0 };
+        static inline std::bernoulli_distribution s_assign { 0.0 };
+};
+
+
+/**
+ * A throwing element.
+ *
+ * Both operations decide whether to fail before they touch anything, so a failed assignment leaves the target exactly as
+ * it was. That's the one requirement Item 11 places on T, and it's what allows a Stack to be exception-safe at all.
+*/
+
+template <class Payload>
+class Faulty
+{
+    public:
+        Faulty(Payload value = Payload { })
+            : m_value { std::move(value) } { }
+
+        Faulty(const Faulty& other)
+            : m_value { (FaultInjector::copy(), other.m_value) } { }
+
+        Faulty& operator = (const Faulty& other)
+        {
+            FaultInjector::assign();
+            m_value = other.m_value;
+
+            return *this;
+        }
+
+        const Payload& value() const
+        {
+            return m_value;
+        }
+
+    private:
+        Payload m_value;
+};
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Item 10: a default-constructed T[] buffer, grown with newCopy() and filled by assignment.
+*/
+
+namespace item10
+{
+    template <class T>
+    T* newCopy(const T* source, std::size_t sourceSize, std::size_t destSize)
+    {
+        T* dest = new T[destSize];
+
+        try
+        {
+            std::copy(source, source + sourceSize, dest);
+        }
+        catch ( ... )
+        {
+            delete[] dest;
+            throw;
+        }
+
+        return dest;
+    }
+
+    template <class T>
+    class Stack
+    {
+        public:
+            Stack()
+                : m_v { new T[10] }, m_size { 10 }, m_used { 0 } { }
+
+            ~Stack() noexcept
+            {
+                delete[] m_v;
+            }
+
+            Stack(const Stack& other)
+                : m_v { newCopy(other.m_v, other.m_used, other.m_size) }, m_size { other.m_size }, m_used { other.m_used } { }
+
+            Stack& operator = (const Stack& other)
+            {
+                if (this != &other)
+                {
+                    T* newObject { newCopy(other.m_v, other.m_used, other.m_size) };
+
+                    delete[] m_v;
+
+                    m_v = newObject;
+                    m_size = other.m_size;
+                    m_used = other.m_used;
+                }
+
+                return *this;
+            }
+
+            std::size_t count() const
+            {
+                return m_used;
+            }
+
+            void push(const T& element)
+            {
+                if (m_used == m_size)
+                {
+                    std::size_t newSize { m_size * 2 + 1 };
+                    T* m_vNew { newCopy(m_v, m_size, newSize) };
+
+                    delete[] m_v;
+
+                    m_v = m_vNew;
+                    m_size = newSize;
+                }
+
+                m_v[m_used] = element;
+                ++m_used;
+            }
+
+            const T& top() const
+            {
+                if (m_used == 0)
+                {
+                    throw("Empty Stack");
+                }
+
+                return m_v[m_used - 1];
+            }
+
+            void pop()
+            {
+                if (m_used == 0)
+                {
+                    throw("Popping from empty stack.");
+                }
+
+                --m_used;
+            }
+
+        private:
+            T* m_v;
+            std::size_t m_size;
+            std::size_t m_used;
+    };
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Items 13 and 14: raw StackImpl memory, elements copy-constructed in place, growth and assignment by copy-and-swap. They
+ * share the StackImpl; they differ only in whether Stack inherits from it or holds it as a member.
+*/
+
+namespace item12
+{
+    template <class T>
+    class StackImpl
+    {
+        public:
+            StackImpl(std::size_t size = 0)
+                : m_v { static_cast<T*>(size == 0 ? nullptr : operator new(sizeof(T) * size)) }, m_size { size },
+                  m_used { 0 } { }
+
+            ~StackImpl()
+            {
+                std::destroy(m_v, m_v + m_used);
+                operator delete(m_v);
+            }
+
+            StackImpl(const StackImpl& other) = delete;
+            StackImpl& operator = (const StackImpl& other) = delete;
+
+            void swap(StackImpl& other) noexcept
+            {
+                std::swap(m_v, other.m_v);
+                std::swap(m_size, other.m_size);
+                std::swap(m_used, other.m_used);
+            }
+
+            T* m_v;
+            std::size_t m_size;
+            std::size_t m_used;
+    };
+}
+
+namespace item13
+{
+    template <class T>
+    class Stack : private item12::StackImpl<T>
+    {
+        public:
+            Stack(std::size_t size = 0)
+                : item12::StackImpl<T> { size } { }
+
+            Stack(const Stack& other)
+                : item12::StackImpl<T> { other.m_used }
+            {
+                while (m_used < other.m_used)
+                {
+                    new (m_v + m_used) T(other.m_v[m_used]);
+                    ++m_used;
+                }
+            }
+
+            Stack& operator = (const Stack& other)
+            {
+                Stack temp { other };
+                this->swap(temp);
+
+                return *this;
+            }
+
+            std::size_t count() const
+            {
+                return m_used;
+            }
+
+            void push(const T& element)
+            {
+                if (m_used == m_size)
+                {
+                    Stack temp { m_size * 2 + 1 };
+
+                    while (temp.count() < m_used)
+                    {
+                        temp.push(m_v[ temp.count() ]);
+                    }
+
+                    temp.push(element);
+                    this->swap(temp);
+                }
+                else
+                {
+                    new (m_v + m_used) T(element);
+                    ++m_used;
+                }
+            }
+
+            const T& top() const
+            {
+                if (m_used == 0)
+                {
+                    throw("Empty Stack");
+                }
+
+                return m_v[m_used - 1];
+            }
+
+            void pop()
+            {
+                if (m_used == 0)
+                {
+                    throw("Popping from empty stack.");
+                }
+
+                --m_used;
+                std::destroy_at(m_v + m_used);
+            }
+
+        private:
+            using item12::StackImpl<T>::m_v;
+            using item12::StackImpl<T>::m_size;
+            using item12::StackImpl<T>::m_used;
+    };
+}
+
+namespace item14
+{
+    template <class T>
+    class Stack
+    {
+        public:
+            Stack(std::size_t size = 0)
+                : m_impl { size } { }
+
+            Stack(const Stack& other)
+                : m_impl { other.m_impl.m_used }
+            {
+                while (m_impl.m_used < other.m_impl.m_used)
+                {
+                    new (m_impl.m_v + m_impl.m_used) T(other.m_impl.m_v[m_impl.m_used]);
+                    ++m_impl.m_used;
+                }
+            }
+
+            Stack& operator = (const Stack& other)
+            {
+                Stack temp { other };
+                m_impl.swap(temp.m_impl);
+
+                return *this;
+            }
+
+            std::size_t count() const
+            {
+                return m_impl.m_used;
+            }
+
+            void push(const T& element)
+            {
+                if (m_impl.m_used == m_impl.m_size)
+                {
+                    Stack temp { m_impl.m_size * 2 + 1 };
+
+                    while (temp.count() < m_impl.m_used)
+                    {
+                        temp.push(m_impl.m_v[temp.count()]);
+                    }
+
+                    temp.push(element);
+                    m_impl.swap(temp.m_impl);
+                }
+                else
+                {
+                    new (m_impl.m_v + m_impl.m_used) T(element);
+                    ++m_impl.m_used;
+                }
+            }
+
+            const T& top() const
+            {
+                if (m_impl.m_used == 0)
+                {
+                    throw("Empty Stack");
+                }
+
+                return m_impl.m_v[m_impl.m_used - 1];
+            }
+
+            void pop()
+            {
+                if (m_impl.m_used == 0)
+                {
+                    throw("Pop from an empty stack.");
+                }
+
+                --m_impl.m_used;
+                std::destroy_at(m_impl.m_v + m_impl.m_used);
+            }
+
+        private:
+            item12::StackImpl<T> m_impl;
+    };
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * The harness.
+ *
+ * Every run replays the same pseudo-random mix of push, pop, copy construction and copy assignment, so the designs see
+ * identical work. A timed pass measures throughput. A separate verifying pass snapshots the Stack before every operation
+ * (with injection suspended) and compares it with the Stack after every operation that threw; it's kept out of the timed
+ * pass because a snapshot costs far more than the operation it checks.
+*/
+
+struct Result
+{
+    std::size_t m_operations { 0 };
+    std::size_t m_failures { 0 };
+    double m_successNanoseconds { 0 };
+    double m_failureNanoseconds { 0 };
+
+    std::size_t m_unchanged { 0 };
+    std::size_t m_changed { 0 };
+    std::size_t m_broken { 0 };
+};
+
+enum class Operation { push, pop, copy, assign };
+
+
+template <class Stack>
+auto snapshot(const Stack& stack)
+{
+    FaultInjector::Suspend suspend;
+
+    Stack copy { stack };
+    std::vector<std::decay_t<decltype(stack.top().value())>> contents;
+
+    while (copy.count() != 0)
+    {
+        contents.push_back(copy.top().value());
+        copy.pop();
+    }
+
+    return contents;
+}
+
+
+template <class Stack, class Payload>
+void apply(Operation operation, Stack& stack, const Stack& other, const Payload& value)
+{
+    switch (operation)
+    {
+        case Operation::push:   stack.push(Faulty<Payload> { value });     break;
+        case Operation::pop:    stack.pop();                              break;
+        case Operation::copy:   Stack { stack };                          break;
+        case Operation::assign: stack = other;                            break;
+    }
+}
+
+
+template <class Stack, class Payload>
+Result measure(std::size_t operations, const Payload& value, bool verify)
+{
+    Result result;
+    std::mt19937 workload { 42 };
+    std::uniform_int_distribution<int> percent { 0, 99 };
+
+    Stack stack;
+    Stack other;
+
+    {
+        FaultInjector::Suspend suspend;
+
+        for (int i { 0 }; i < 32; ++i)
+        {
+            other.push(Faulty<Payload> { value });
+        }
+    }
+
+    for (std::size_t i { 0 }; i < operations; ++i)
+    {
+        int roll { percent(workload) };
+        Operation operation { stack.count() == 0 ? Operation::push
+                              : roll < (stack.count() > 256 ? 30 : 55) ? Operation::push
+                              : roll < 90 ? Operation::pop
+                              : roll < 95 ? Operation::copy
+                              : Operation::assign };
+
+        decltype(snapshot(stack)) before;
+
+        if (verify)
+        {
+            before = snapshot(stack);
+        }
+
+        auto start { std::chrono::steady_clock::now() };
+        bool failed { false };
+
+        try
+        {
+            apply(operation, stack, other, value);
+        }
+        catch (const InjectedFault&)
+        {
+            failed = true;
+        }
+
+        std::chrono::duration<double, std::nano> elapsed { std::chrono::steady_clock::now() - start };
+
+        ++result.m_operations;
+        (failed ? result.m_failureNanoseconds : result.m_successNanoseconds) += elapsed.count();
+
+        if (!failed)
+        {
+            continue;
+        }
+
+        ++result.m_failures;
+
+        if (verify)
+        {
+            try
+            {
+                (snapshot(stack) == before ? result.m_unchanged : result.m_changed)++;
+            }
+            catch ( ... )
+            {
+                ++result.m_broken;
+            }
+        }
+    }
+
+    return result;
+}
+
+
+template <template <class> class Stack, class Payload>
+void report(std::string_view design, std::string_view element, const Payload& value, double copyRate, double assignRate)
+{
+    constexpr std::size_t timedOperations { 1'000'000 };
+    constexpr std::size_t verifiedOperations { 20'000 };
+
+    FaultInjector::configure(copyRate, assignRate);
+    Result timed { measure<Stack<Faulty<Payload>>>(timedOperations, value, false) };
+
+    FaultInjector::configure(copyRate, assignRate);
+    Result verified { measure<Stack<Faulty<Payload>>>(verifiedOperations, value, true) };
+
+    std::size_t successes { timed.m_operations - timed.m_failures };
+
+    std::cout << design << ", " << element << ", copy " << copyRate << ", assign " << assignRate << ": "
+              << timed.m_operations / ((timed.m_successNanoseconds + timed.m_failureNanoseconds) / 1e9) << " ops/s, "
+              << (successes ? timed.m_successNanoseconds / successes : 0) << " ns/ok, "
+              << (timed.m_failures ? timed.m_failureNanoseconds / timed.m_failures : 0) << " ns/throw; "
+              << verified.m_failures << " failures checked: " << verified.m_unchanged << " unchanged, "
+              << verified.m_changed << " changed, " << verified.m_broken << " broken\n";
+}
+
+
+template <class Payload>
+void reportAll(std::string_view element, const Payload& value)
+{
+    constexpr std::pair<double, double> rates[] { { 0.0, 0.0 }, { 0.001, 0.0 }, { 0.0, 0.001 }, { 0.01, 0.01 }, { 0.1, 0.1 } };
+
+    for (auto [copyRate, assignRate] : rates)
+    {
+        report<item10::Stack>("Item 10", element, value, copyRate, assignRate);
+        report<item13::Stack>("Item 13", element, value, copyRate, assignRate);
+        report<item14::Stack>("Item 14", element, value, copyRate, assignRate);
+    }
+}
+
+
+void faultInjection()
+{
+    reportAll("int", 7);
+    reportAll("string", std::string(64, 'x'));
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Comparing the designs.
+ *
+ * Items 08-14 arrive at three different Stacks: a default-constructed T[] buffer grown with newCopy() (Item 10), StackImpl
+ * as a private base (Item 13) and StackImpl as a member (Item 14). The suite below times the same workloads on all three,
+ * with std::vector and std::stack as baselines:
+ *
+ * - push:   push N elements onto an empty container.
+ * - pop:    pop N elements off a full one.
+ * - copy:   copy-construct a container of N elements.
+ * - assign: copy-assign a container of N elements over one of N / 2.
+ *
+ * Each workload runs with a trivial element (int), a string-like one (a std::string too long for the small-string buffer)
+ * and a heavy one (256 bytes of payload). For every run we report time stamp counter ticks per element (nanoseconds where
+ * there is no TSC), the number of heap allocations, and the peak number of live heap bytes. Replacing the global operator
+ * new() is what makes the last two possible. Peak RSS is per process, so it's printed once at the end.
+*/
+
+class AllocationCounter
+{
+    public:
+        static void reset()
+        {
+            s_allocations = 0;
+            s_baseline = s_live;
+            s_peak = s_live;
+        }
+
+        static void allocated(std::size_t bytes)
+        {
+            ++s_allocations;
+            s_live += bytes;
+            s_peak = std::max(s_peak, s_live);
+        }
+
+        static void released(std::size_t bytes)
+        {
+            s_live -= bytes;
+        }
+
+        static inline std::size_t s_allocations { 0 };
+        static inline std::size_t s_live { 0 };
+        static inline std::size_t s_peak { 0 };
+        static inline std::size_t s_baseline { 0 };
+};
+
+
+/**
+ * Every block carries its size in a header, because the unsized operator delete() has to know how much it releases.
+*/
+void* operator new(std::size_t bytes)
+{
+    constexpr std::size_t header { alignof(std::max_align_t) };
+
+    void* block { std::malloc(bytes + header) };
+
+    if (!block)
+    {
+        throw std::bad_alloc { };
+    }
+
+    *static_cast<std::size_t*>(block) = bytes;
+    AllocationCounter::allocated(bytes);
+
+    return static_cast<char*>(block) + header;
+}
+
+
+void operator delete(void* pointer) noexcept
+{
+    constexpr std::size_t header { alignof(std::max_align_t) };
+
+    if (pointer)
+    {
+        void* block { static_cast<char*>(pointer) - header };
+
+        AllocationCounter::released(*static_cast<std::size_t*>(block));
+        std::free(block);
+    }
+}
+
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    operator delete(pointer);
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * Element types and a few adapters, so one benchmark template can drive every container.
+*/
+
+struct Heavy
+{
+    std::array<double, 32> m_values { };
+};
+
+template <class Element>
+Element sample(std::size_t index)
+{
+    if constexpr (std::is_same_v<Element, std::string>)
+    {
+        return std::string(32, static_cast<char>('a' + index % 26));
+    }
+    else if constexpr (std::is_same_v<Element, Heavy>)
+    {
+        Heavy heavy;
+        heavy.m_values.fill(static_cast<double>(index));
+
+        return heavy;
+    }
+    else
+    {
+        return static_cast<Element>(index);
+    }
+}
+
+
+template <class Container, class Element>
+void push(Container& container, const Element& element)
+{
+    if constexpr (requires { container.push_back(element); })
+    {
+        container.push_back(element);
+    }
+    else
+    {
+        container.push(element);
+    }
+}
+
+
+template <class Container>
+void pop(Container& container)
+{
+    if constexpr (requires { container.pop_back(); })
+    {
+        container.pop_back();
+    }
+    else
+    {
+        container.pop();
+    }
+}
+
+
+std::uint64_t ticks()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * One measurement.
+ *
+ * Setup that isn't part of the workload (filling the container to pop from, building the source of a copy) happens before
+ * the counters are reset, and tearing the containers down happens after the clock has stopped. The best of a few
+ * repetitions is reported, which filters out most scheduling noise.
+*/
+
+enum class Workload { push, pop, copy, assign };
+
+struct Measurement
+{
+    double m_ticksPerElement;
+    std::size_t m_allocations;
+    std::size_t m_peakBytes;
+};
+
+
+template <class Container, class Element>
+Measurement benchmark(Workload workload, std::size_t elements)
+{
+    constexpr int repetitions { 5 };
+
+    Measurement best { std::numeric_limits<double>::max(), 0, 0 };
+
+    for (int repetition { 0 }; repetition < repetitions; ++repetition)
+    {
+        Container source;
+        Container target;
+
+        if (workload != Workload::push)
+        {
+            for (std::size_t i { 0 }; i < elements; ++i)
+            {
+                push(source, sample<Element>(i));
+            }
+        }
+
+        if (workload == Workload::assign)
+        {
+            for (std::size_t i { 0 }; i < elements / 2; ++i)
+            {
+                push(target, sample<Element>(i));
+            }
+        }
+
+        std::vector<Element> samples;
+        std::optional<Container> copy;
+
+        if (workload == Workload::push)
+        {
+            for (std::size_t i { 0 }; i < elements; ++i)
+            {
+                samples.push_back(sample<Element>(i));
+            }
+        }
+
+        AllocationCounter::reset();
+        std::uint64_t start { ticks() };
+
+        switch (workload)
+        {
+            case Workload::push:
+                for (const Element& element : samples)
+                {
+                    push(source, element);
+                }
+                break;
+
+            case Workload::pop:
+                for (std::size_t i { 0 }; i < elements; ++i)
+                {
+                    pop(source);
+                }
+                break;
+
+            case Workload::copy:
+                copy.emplace(source);
+                break;
+
+            case Workload::assign:
+                target = source;
+                break;
+        }
+
+        double perElement { static_cast<double>(ticks() - start) / elements };
+
+        if (perElement < best.m_ticksPerElement)
+        {
+            best = { perElement, AllocationCounter::s_allocations,
+                     AllocationCounter::s_peak - AllocationCounter::s_baseline };
+        }
+    }
+
+    return best;
+}
+
+/* -------------------------------------------------------------------------------------------------------------------- */
+
+/**
+ * The suite.
+ *
+ * Peak bytes is measured above whatever was live when the workload started, so for "copy" it's the size of the copy and
+ * for "push" it includes every intermediate buffer that was alive at the same time as its successor.
+*/
+
+template <class Container, class Element>
+void compare(std::string_view design, std::string_view element, std::size_t elements)
+{
+    constexpr std::pair<Workload, std::string_view> workloads[]
+    {
+        { Workload::push, "push" }, { Workload::pop, "pop" }, { Workload::copy, "copy" }, { Workload::assign, "assign" }
+    };
+
+    for (auto [workload, name] : workloads)
+    {
+        Measurement measurement { benchmark<Container, Element>(workload, elements) };
+
+        std::cout << std::left << std::setw(14) << design << std::setw(8) << element << std::setw(8) << name
+                  << std::right << std::fixed << std::setprecision(1) << std::setw(10) << measurement.m_ticksPerElement
+                  << " ticks/op" << std::setw(10) << measurement.m_allocations << " allocations"
+                  << std::setw(12) << measurement.m_peakBytes << " peak bytes\n";
+    }
+}
+
+
+template <class Element>
+void compareAll(std::string_view element, std::size_t elements)
+{
+    compare<item10::Stack<Element>, Element>("Item 10", element, elements);
+    compare<item13::Stack<Element>, Element>("Item 13", element, elements);
+    compare<item14::Stack<Element>, Element>("Item 14", element, elements);
+    compare<std::vector<Element>, Element>("std::vector", element, elements);
+    compare<std::stack<Element>, Element>("std::stack", element, elements);
+}
+
+
+void designComparison()
+{
+    constexpr std::size_t elements { 100'000 };
+
+    compareAll<int>("int", elements);
+    compareAll<std::string>("string", elements);
+    compareAll<Heavy>("heavy", elements);
+
+    rusage usage { };
+    getrusage(RUSAGE_SELF, &usage);
+
+    std::cout << "peak RSS: " << usage.ru_maxrss << " KiB\n" << std::defaultfloat << std::setprecision(6);
+}
+
+
+int main()
+{
+    designComparison();
+    faultInjection();
 }
\ No newline at end of file